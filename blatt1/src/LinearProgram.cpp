@@ -1,5 +1,6 @@
 #include "LinearProgram.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -25,12 +26,9 @@ LinearProgram::LinearProgram(std::string input_file) {
         file >> tmp;
         constraints.push_back(tmp);
     }
-    for (unsigned int i=0; i<rows; i++) {
-        matrix.push_back(std::vector<double>());
-        for (unsigned int j=0; j<cols; j++) {
-            file >> tmp;
-            matrix[i].push_back(tmp);
-        }
+    matrix.resize((size_t) rows * cols);
+    for (size_t i=0; i<matrix.size(); i++) {
+        file >> matrix[i];
     }
 }
 
@@ -50,7 +48,7 @@ double LinearProgram::getMatValue(unsigned int row, unsigned int col) {
         throw std::invalid_argument("Index out of bounds");
     }
 
-    return matrix[row][col];
+    return matrix[(size_t) row * cols + col];
 }
 
 // Gets the `index`th coefficient of the objective function
@@ -77,15 +75,51 @@ void LinearProgram::addRow(std::vector<double>& rowVals, double constraint) {
         throw std::invalid_argument("Size of new row does not equal the width of the matrix");
     }
 
-    matrix.push_back(rowVals);
+    addRow(rowVals.data(), constraint);
+}
+
+// Adds a new side condition with the first `cols` values of rowVals to the LP
+void LinearProgram::addRow(const double* rowVals, double constraint) {
+    matrix.insert(matrix.end(), rowVals, rowVals + cols);
     constraints.push_back(constraint);
     rows++;
 }
 
-std::vector<double>& LinearProgram::getRow(unsigned int index) {
+// Gets a view of the `index`th row
+RowView LinearProgram::getRow(unsigned int index) {
     if (index >= rows) {
         throw std::invalid_argument("Index out of bounds");
     }
 
-    return matrix[index];
+    return row(index);
+}
+
+// Reserves memory for `count` rows in total, so adding rows up to that number does not allocate
+void LinearProgram::reserveRows(unsigned int count) {
+    matrix.reserve((size_t) count * cols);
+    constraints.reserve(count);
+}
+
+// Sets the number of rows to `count`, new rows are filled with zeros
+void LinearProgram::resizeRows(unsigned int count) {
+    rows = count;
+    matrix.resize((size_t) rows * cols, 0);
+    constraints.resize(rows, 0);
+}
+
+// Removes the rows i with keep[i] == false, the other rows keep their order
+void LinearProgram::keepRows(std::vector<bool>& keep) {
+    unsigned int next = 0;
+    for (unsigned int i=0; i<rows; i++) {
+        if (keep[i]) {
+            if (next != i) {
+                std::copy(row(i).begin(), row(i).end(), row(next).begin());
+                constraints[next] = constraints[i];
+            }
+            next++;
+        }
+    }
+    rows = next;
+    matrix.resize((size_t) rows * cols);
+    constraints.resize(rows);
 }
\ No newline at end of file
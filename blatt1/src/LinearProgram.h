@@ -6,7 +6,20 @@
 #include <fstream>
 #include <vector>
 
+// View of a row of a matrix, valid until rows are added to or removed from the matrix
+class RowView {
+public:
+    RowView(double* values, unsigned int size) : values(values), size(size) { }
+    double& operator[](unsigned int index) { return values[index]; }
+    double* begin() { return values; }
+    double* end() { return values + size; }
+
+    double* values;
+    unsigned int size;
+};
+
 // A class that describes a linear program
+// The matrix is stored row by row in one array, so rows can be added without allocating memory for each of them.
 class LinearProgram {
 public:
     LinearProgram(std::string input_file);
@@ -17,14 +30,26 @@ public:
     double getObjectiveValue(unsigned int index);
     double getConstraint(unsigned int index);
     void addRow(std::vector<double>& rowVals, double constraint);
-    std::vector<double>& getRow(unsigned int index);
+    void addRow(const double* rowVals, double constraint);
+    RowView getRow(unsigned int index);
+    void reserveRows(unsigned int count);
+    void resizeRows(unsigned int count);
+    void keepRows(std::vector<bool>& keep);
+
+    // Access without bounds checks for inner loops
+    RowView row(unsigned int index) {
+        return RowView(matrix.data() + (size_t) index * cols, cols);
+    }
+    double& constraint(unsigned int index) {
+        return constraints[index];
+    }
 
 private:
     unsigned int rows = 0;
     unsigned int cols = 0;
-    std::vector<std::vector<double>> matrix;
+    std::vector<double> matrix; // row-major, rows * cols values
     std::vector<double> constraints;
     std::vector<double> objectiveFunction;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,161 @@
+/* Row kernels, vectorized versions are selected at runtime */
+#include "RowKernels.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+double combineValues(double a, double sa, double b, double sb) {
+    return a*sa - b*sb;
+}
+
+void combineScalar(double* out, const double* a, double sa, const double* b, double sb, unsigned int n) {
+    for (unsigned int k=0; k<n; k++) {
+        out[k] = combineValues(a[k], sa, b[k], sb);
+    }
+}
+
+double dotScalar(const double* a, const double* b, unsigned int n) {
+    double res = 0;
+    for (unsigned int k=0; k<n; k++) {
+        res += a[k]*b[k];
+    }
+    return res;
+}
+
+void axpyScalar(double* out, double s, const double* a, unsigned int n) {
+    for (unsigned int k=0; k<n; k++) {
+        out[k] += s*a[k];
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+// Four values per step, the rest like a single lane
+__attribute__((target("avx2,fma")))
+void combineAvx2(double* out, const double* a, double sa, const double* b, double sb, unsigned int n) {
+    __m256d va = _mm256_set1_pd(sa);
+    __m256d vb = _mm256_set1_pd(sb);
+    unsigned int k = 0;
+    for (; k+4 <= n; k += 4) {
+        __m256d r = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(a + k), va), _mm256_mul_pd(_mm256_loadu_pd(b + k), vb));
+        _mm256_storeu_pd(out + k, r);
+    }
+    for (; k < n; k++) {
+        out[k] = combineValues(a[k], sa, b[k], sb);
+    }
+}
+
+// Two accumulators hide the latency of the fused multiply-adds
+__attribute__((target("avx2,fma")))
+double dotAvx2(const double* a, const double* b, unsigned int n) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    unsigned int k = 0;
+    for (; k+8 <= n; k += 8) {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k), sum0);
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4), sum1);
+    }
+    if (k+4 <= n) {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k), sum0);
+        k += 4;
+    }
+    __m256d sum = _mm256_add_pd(sum0, sum1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double res = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; k < n; k++) {
+        res = std::fma(a[k], b[k], res);
+    }
+    return res;
+}
+
+__attribute__((target("avx2,fma")))
+void axpyAvx2(double* out, double s, const double* a, unsigned int n) {
+    __m256d vs = _mm256_set1_pd(s);
+    unsigned int k = 0;
+    for (; k+4 <= n; k += 4) {
+        _mm256_storeu_pd(out + k, _mm256_fmadd_pd(_mm256_loadu_pd(a + k), vs, _mm256_loadu_pd(out + k)));
+    }
+    for (; k < n; k++) {
+        out[k] = std::fma(a[k], s, out[k]);
+    }
+}
+
+// Eight values per step, the rest with a masked step
+__attribute__((target("avx512f")))
+void combineAvx512(double* out, const double* a, double sa, const double* b, double sb, unsigned int n) {
+    __m512d va = _mm512_set1_pd(sa);
+    __m512d vb = _mm512_set1_pd(sb);
+    for (unsigned int k=0; k<n; k += 8) {
+        __mmask8 mask = n-k >= 8 ? 0xff : (__mmask8) ((1u << (n-k)) - 1);
+        __m512d r = _mm512_sub_pd(_mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + k), va), _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b + k), vb));
+        _mm512_mask_storeu_pd(out + k, mask, r);
+    }
+}
+
+__attribute__((target("avx512f")))
+double dotAvx512(const double* a, const double* b, unsigned int n) {
+    __m512d sum = _mm512_setzero_pd();
+    for (unsigned int k=0; k<n; k += 8) {
+        __mmask8 mask = n-k >= 8 ? 0xff : (__mmask8) ((1u << (n-k)) - 1);
+        sum = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + k), _mm512_maskz_loadu_pd(mask, b + k), sum);
+    }
+    return _mm512_reduce_add_pd(sum);
+}
+
+__attribute__((target("avx512f")))
+void axpyAvx512(double* out, double s, const double* a, unsigned int n) {
+    __m512d vs = _mm512_set1_pd(s);
+    for (unsigned int k=0; k<n; k += 8) {
+        __mmask8 mask = n-k >= 8 ? 0xff : (__mmask8) ((1u << (n-k)) - 1);
+        _mm512_mask_storeu_pd(out + k, mask, _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + k), vs, _mm512_maskz_loadu_pd(mask, out + k)));
+    }
+}
+
+#endif
+
+RowKernels selectRowKernels(std::string name) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#else
+    bool avx2 = false;
+    bool avx512 = false;
+#endif
+
+    if (name == "auto") {
+        name = avx512 ? "avx512" : avx2 ? "avx2" : "scalar";
+    }
+    RowKernels kernels;
+    kernels.name = name;
+    if (name == "scalar") {
+        kernels.combine = combineScalar;
+        kernels.dot = dotScalar;
+        kernels.axpy = axpyScalar;
+        return kernels;
+    }
+#ifdef HAVE_X86_KERNELS
+    if (name == "avx2" && avx2) {
+        kernels.combine = combineAvx2;
+        kernels.dot = dotAvx2;
+        kernels.axpy = axpyAvx2;
+        return kernels;
+    } else if (name == "avx512" && avx512) {
+        kernels.combine = combineAvx512;
+        kernels.dot = dotAvx512;
+        kernels.axpy = axpyAvx512;
+        return kernels;
+    }
+#endif
+    throw std::invalid_argument("Unknown or unsupported row kernel " + name);
+}
+
+RowKernels& rowKernels() {
+    static RowKernels kernels = selectRowKernels("auto");
+    return kernels;
+}
@@ -0,0 +1,28 @@
+#ifndef ROWKERNELS_H
+#define ROWKERNELS_H
+
+#include <string>
+
+// a*sa - b*sb, both products are rounded before the subtraction like in every combine kernel
+double combineValues(double a, double sa, double b, double sb);
+
+// Loops over rows of doubles that the elimination and the certificate check spend their time in.
+// combine gives the same results with every instruction set, dot and axpy may differ in the last bits.
+class RowKernels {
+public:
+    // out[k] = combineValues(a[k], sa, b[k], sb) for k < n
+    void (*combine)(double* out, const double* a, double sa, const double* b, double sb, unsigned int n);
+    // Sum of a[k]*b[k] for k < n
+    double (*dot)(const double* a, const double* b, unsigned int n);
+    // out[k] += s*a[k] for k < n
+    void (*axpy)(double* out, double s, const double* a, unsigned int n);
+    std::string name;
+};
+
+// Gets the kernels by name (scalar, avx2, avx512) or the widest ones the CPU supports for "auto".
+// Throws if the name is unknown or the CPU does not support the instruction set.
+RowKernels selectRowKernels(std::string name);
+// Kernels used by scalarMult, the elimination and the certificate check, "auto" unless replaced
+RowKernels& rowKernels();
+
+#endif
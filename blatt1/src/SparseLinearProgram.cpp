@@ -0,0 +1,199 @@
+#include "SparseLinearProgram.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Constructs a linear program object by the content of an input file in the sparse format: the number of rows, columns
+// and nonzero coefficients, the objective function, the constraints and then "row column value" for each nonzero
+// coefficient. Indices start at 0, the coefficients can be given in any order.
+SparseLinearProgram::SparseLinearProgram(std::string input_file) {
+    std::ifstream file(input_file);
+
+    if (!file.good()) {
+        throw std::runtime_error("Could not open file");
+    }
+
+    size_t nonzeros;
+    file >> rows;
+    file >> cols;
+    file >> nonzeros;
+
+    double tmp;
+    for (unsigned int i=0; i<cols; i++) {
+        file >> tmp;
+        objectiveFunction.push_back(tmp);
+    }
+    for (unsigned int i=0; i<rows; i++) {
+        file >> tmp;
+        constraints.push_back(tmp);
+    }
+
+    std::vector<std::tuple<unsigned int, unsigned int, double>> entries(nonzeros);
+    for (size_t k=0; k<nonzeros; k++) {
+        file >> std::get<0>(entries[k]) >> std::get<1>(entries[k]) >> std::get<2>(entries[k]);
+        if (std::get<0>(entries[k]) >= rows || std::get<1>(entries[k]) >= cols) {
+            throw std::invalid_argument("Index out of bounds");
+        }
+    }
+    if (!file) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+    std::sort(entries.begin(), entries.end());
+
+    start.assign(rows + 1, 0);
+    indices.reserve(nonzeros);
+    values.reserve(nonzeros);
+    for (size_t k=0; k<nonzeros; k++) {
+        unsigned int row = std::get<0>(entries[k]);
+        unsigned int col = std::get<1>(entries[k]);
+        if (k > 0 && std::get<0>(entries[k-1]) == row && std::get<1>(entries[k-1]) == col) {
+            throw std::invalid_argument("Coefficient given twice");
+        }
+        // Explicit zeros are not stored
+        if (std::get<2>(entries[k]) != 0) {
+            indices.push_back(col);
+            values.push_back(std::get<2>(entries[k]));
+            start[row+1]++;
+        }
+    }
+    for (unsigned int i=0; i<rows; i++) {
+        start[i+1] += start[i];
+    }
+}
+
+// Constructs a sparse copy of a dense linear program
+SparseLinearProgram::SparseLinearProgram(LinearProgram& lp) : SparseLinearProgram(lp.getColCount()) {
+    for (unsigned int j=0; j<cols; j++) {
+        objectiveFunction.push_back(lp.getObjectiveValue(j));
+    }
+    for (unsigned int i=0; i<lp.getRowCount(); i++) {
+        RowView row = lp.row(i);
+        for (unsigned int j=0; j<cols; j++) {
+            if (row[j] != 0) {
+                indices.push_back(j);
+                values.push_back(row[j]);
+            }
+        }
+        start.push_back(indices.size());
+        constraints.push_back(lp.constraint(i));
+        rows++;
+    }
+}
+
+// Gets the amount of rows
+unsigned int SparseLinearProgram::getRowCount() {
+    return rows;
+}
+
+// Gets the amount of cols
+unsigned int SparseLinearProgram::getColCount() {
+    return cols;
+}
+
+// Gets the amount of stored coefficients
+size_t SparseLinearProgram::getNonzeroCount() {
+    return indices.size();
+}
+
+// Gets the value of the matrix in the `row`th row and `col`th column
+double SparseLinearProgram::getMatValue(unsigned int row, unsigned int col) {
+    if (row >= getRowCount() || col >= getColCount()) {
+        throw std::invalid_argument("Index out of bounds");
+    }
+
+    auto first = indices.begin() + start[row];
+    auto last = indices.begin() + start[row+1];
+    auto it = std::lower_bound(first, last, col);
+    if (it == last || *it != col) {
+        return 0;
+    }
+    return values[it - indices.begin()];
+}
+
+// Gets the `index`th coefficient of the objective function
+double SparseLinearProgram::getObjectiveValue(unsigned int index) {
+    if (index >= objectiveFunction.size()) {
+        throw std::invalid_argument("Index out of bounds");
+    }
+
+    return objectiveFunction[index];
+}
+
+// Gets the `index`th constraint
+double SparseLinearProgram::getConstraint(unsigned int index) {
+    if (index >= rows) {
+        throw std::invalid_argument("Index out of bounds");
+    }
+
+    return constraints[index];
+}
+
+// Adds a new side condition with the nonzero coefficients rowVals[k] for the columns rowIndices[k], k < size, which
+// have to be sorted
+void SparseLinearProgram::addRow(const unsigned int* rowIndices, const double* rowVals, unsigned int size, double constraint) {
+    indices.insert(indices.end(), rowIndices, rowIndices + size);
+    values.insert(values.end(), rowVals, rowVals + size);
+    start.push_back(indices.size());
+    constraints.push_back(constraint);
+    rows++;
+}
+
+// Adds the side conditions of another program with the same number of columns
+void SparseLinearProgram::addRows(SparseLinearProgram& other) {
+    if (other.cols != cols) {
+        throw std::invalid_argument("Size of new rows does not equal the width of the matrix");
+    }
+
+    size_t offset = indices.size();
+    indices.insert(indices.end(), other.indices.begin(), other.indices.end());
+    values.insert(values.end(), other.values.begin(), other.values.end());
+    for (unsigned int i=0; i<other.rows; i++) {
+        start.push_back(offset + other.start[i+1]);
+    }
+    constraints.insert(constraints.end(), other.constraints.begin(), other.constraints.end());
+    rows += other.rows;
+}
+
+// Gets a view of the `index`th row
+SparseRowView SparseLinearProgram::getRow(unsigned int index) {
+    if (index >= rows) {
+        throw std::invalid_argument("Index out of bounds");
+    }
+
+    return row(index);
+}
+
+// Reserves memory for `rowCount` rows with `nonzeros` coefficients in total
+void SparseLinearProgram::reserve(unsigned int rowCount, size_t nonzeros) {
+    start.reserve(rowCount + 1);
+    constraints.reserve(rowCount);
+    indices.reserve(nonzeros);
+    values.reserve(nonzeros);
+}
+
+// Removes the rows i with keep[i] == false, the other rows keep their order
+void SparseLinearProgram::keepRows(std::vector<bool>& keep) {
+    unsigned int next = 0;
+    size_t end = 0;
+    for (unsigned int i=0; i<rows; i++) {
+        if (keep[i]) {
+            size_t first = start[i];
+            size_t last = start[i+1];
+            std::copy(indices.begin() + first, indices.begin() + last, indices.begin() + end);
+            std::copy(values.begin() + first, values.begin() + last, values.begin() + end);
+            end += last - first;
+            constraints[next] = constraints[i];
+            next++;
+            start[next] = end;
+        }
+    }
+    rows = next;
+    start.resize(rows + 1);
+    indices.resize(end);
+    values.resize(end);
+    constraints.resize(rows);
+}
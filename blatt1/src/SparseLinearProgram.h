@@ -0,0 +1,59 @@
+#ifndef SPARSELINEARPROGRAM_H
+#define SPARSELINEARPROGRAM_H
+
+#include "LinearProgram.h"
+
+#include <string>
+#include <vector>
+
+// View of the nonzero coefficients of a row of a sparse matrix, sorted by column. Valid until rows are added to or removed
+// from the matrix.
+class SparseRowView {
+public:
+    SparseRowView(const unsigned int* indices, const double* values, unsigned int size) : indices(indices), values(values), size(size) { }
+    const double* begin() { return values; }
+    const double* end() { return values + size; }
+
+    const unsigned int* indices;
+    const double* values;
+    unsigned int size;
+};
+
+// A linear program whose matrix only stores the nonzero coefficients, in compressed sparse row form. The coefficients of
+// row i are at start[i] ... start[i+1]-1 of indices and values, sorted by column.
+class SparseLinearProgram {
+public:
+    SparseLinearProgram(std::string input_file);
+    SparseLinearProgram(LinearProgram& lp);
+    SparseLinearProgram(unsigned int cols) : cols(cols), start(1, 0) { }
+    unsigned int getRowCount();
+    unsigned int getColCount();
+    size_t getNonzeroCount();
+    double getMatValue(unsigned int row, unsigned int col);
+    double getObjectiveValue(unsigned int index);
+    double getConstraint(unsigned int index);
+    void addRow(const unsigned int* rowIndices, const double* rowVals, unsigned int size, double constraint);
+    void addRows(SparseLinearProgram& other);
+    SparseRowView getRow(unsigned int index);
+    void reserve(unsigned int rowCount, size_t nonzeros);
+    void keepRows(std::vector<bool>& keep);
+
+    // Access without bounds checks for inner loops
+    SparseRowView row(unsigned int index) {
+        return SparseRowView(indices.data() + start[index], values.data() + start[index], start[index+1] - start[index]);
+    }
+    double& constraint(unsigned int index) {
+        return constraints[index];
+    }
+
+private:
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    std::vector<size_t> start; // rows + 1 offsets into indices and values
+    std::vector<unsigned int> indices;
+    std::vector<double> values;
+    std::vector<double> constraints;
+    std::vector<double> objectiveFunction;
+};
+
+#endif
@@ -1,28 +1,375 @@
 #include "LinearProgram.h"
 #include "fouriermotzkin.h"
+#include "RowKernels.h"
+#include "ThreadPool.h"
 
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// Scalar multiplication between to double arrays of length size
+double scalarMult(const double* a, const double* b, unsigned int size) {
+    return rowKernels().dot(a, b, size);
+}
 
 // Scalar multiplication between to double vectors
-double scalarMult(std::vector<double> a, std::vector<double> b) {
+double scalarMult(const std::vector<double>& a, const std::vector<double>& b) {
     if (a.size() != b.size()) {
         throw std::invalid_argument("Dimensions do not match");
     }
 
+    return scalarMult(a.data(), b.data(), a.size());
+}
+
+// Scalar multiplication between a double vector and a row
+double scalarMult(const std::vector<double>& a, RowView b) {
+    if (a.size() != b.size) {
+        throw std::invalid_argument("Dimensions do not match");
+    }
+
+    return scalarMult(a.data(), b.values, b.size);
+}
+
+// Scalar multiplication between a double vector and the nonzeros of a sparse row
+double scalarMult(const std::vector<double>& a, SparseRowView b) {
     double res = 0;
-    for (unsigned int i=0; i<a.size(); i++) {
-        res += a[i]*b[i];
+    for (unsigned int k=0; k<b.size; k++) {
+        if (b.indices[k] >= a.size()) {
+            throw std::invalid_argument("Dimensions do not match");
+        }
+        res += a[b.indices[k]]*b.values[k];
     }
 
     return res;
 }
 
-// Fourier motzkin elimination algorithm to find a feasible solution of an LP or find a certificate that the LP is infeasible
-FourierMotzkinResult fourierMotzkin(LinearProgram& lp) {
+// Marks a row of the next system that is a copy instead of a combination
+const unsigned int NO_ROW = (unsigned int) -1;
+
+// Rows of the next system (a LinearProgram or SparseLinearProgram) and where they come from. Row k is a copy of row first[k] (second[k] is NO_ROW) or the
+// combination of row first[k] with a coefficient < 0 and row second[k] with a coefficient > 0 for the eliminated
+// variable. Row k comes from the original rows whose bits are set in history[k*words] ... history[(k+1)*words-1].
+template <class Program>
+class NextSystem {
+public:
+    NextSystem(unsigned int cols, unsigned int words) : lp(cols), words(words) { }
+
+    Program lp;
+    std::vector<unsigned int> first;
+    std::vector<unsigned int> second;
+    std::vector<uint64_t> history;
+    unsigned int words;
+};
+
+// Combinations of one row with a coefficient < 0 that have not been pruned, stored like the rows of a LinearProgram with
+// the columns of the next level. Row k comes from the row with a coefficient > 0 second[k].
+class CombinedRows {
+public:
+    std::vector<double> values;
+    std::vector<double> constraints;
+    std::vector<unsigned int> second;
+    std::vector<uint64_t> history;
+    unsigned int pruned = 0; // combinations removed by the history criterion
+};
+
+// Combinations of one row with a coefficient < 0 of a sparse system that have not been pruned, like CombinedRows
+class SparseCombinedRows {
+public:
+    SparseCombinedRows(unsigned int cols) : rows(cols) { }
+
+    SparseLinearProgram rows;
+    std::vector<unsigned int> second;
+    std::vector<uint64_t> history;
+    unsigned int pruned = 0; // combinations removed by the history criterion
+};
+
+// State shared by all levels of the elimination
+class EliminationContext {
+public:
+    FourierMotzkinOptions options;
+    FourierMotzkinStats* stats;
+    unsigned int words = 0; // 64-bit words of a history
+    std::vector<uint64_t> nonzero; // original rows with a nonzero coefficient for variable k, as a history at k*words
+    unsigned int eliminated = 0; // variables eliminated so far
+    ThreadPool* pool = nullptr;
+    RowKernels kernels;
+};
+
+// Levels with fewer coefficients to combine are not worth waking up the pool
+const size_t PARALLEL_THRESHOLD = 1 << 14;
+
+// Variable with the smallest index
+unsigned int fixedOrder(ColumnSigns&) {
+    return 0;
+}
+
+// Variable whose elimination adds the fewest rows, |lt0| * |gt0| - |lt0| - |gt0|, ties go to the smaller index
+unsigned int minFillOrder(ColumnSigns& signs) {
+    unsigned int best = 0;
+    long long bestFill = 0;
+    for (unsigned int j=0; j<signs.lt.size(); j++) {
+        long long fill = signs.lt[j] * signs.gt[j] - signs.lt[j] - signs.gt[j];
+        if (j == 0 || fill < bestFill) {
+            best = j;
+            bestFill = fill;
+        }
+    }
+    return best;
+}
+
+// Counts the signs of the coefficients of each column of lp
+ColumnSigns columnSigns(LinearProgram& lp) {
+    ColumnSigns signs;
+    signs.lt.assign(lp.getColCount(), 0);
+    signs.gt.assign(lp.getColCount(), 0);
+    for (unsigned int i=0; i<lp.getRowCount(); i++) {
+        RowView row = lp.row(i);
+        for (unsigned int j=0; j<row.size; j++) {
+            signs.lt[j] += row[j] < 0;
+            signs.gt[j] += row[j] > 0;
+        }
+    }
+    return signs;
+}
+
+EliminationOrder parseEliminationOrder(std::string name) {
+    if (name == "fixed") {
+        return fixedOrder;
+    } else if (name == "fill") {
+        return minFillOrder;
+    }
+    throw std::invalid_argument("Unknown elimination order " + name);
+}
+
+// Counts the original rows in a history
+unsigned int historySize(const uint64_t* history, unsigned int words) {
+    unsigned int count = 0;
+    for (unsigned int w=0; w<words; w++) {
+        count += __builtin_popcountll(history[w]);
+    }
+    return count;
+}
+
+// Checks whether every original row of history a is also in history b
+bool historySubset(const uint64_t* a, const uint64_t* b, unsigned int words) {
+    for (unsigned int w=0; w<words; w++) {
+        if (a[w] & ~b[w]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Counts the variables that the row has lost by cancellation: its coefficient is zero although one of the original
+// rows it comes from has a nonzero one. Column k of the row is variable columns[k].
+unsigned int implicitlyEliminated(const double* row, const uint64_t* history, std::vector<unsigned int>& columns, EliminationContext& context) {
+    unsigned int count = 0;
+    for (unsigned int k=0; k<columns.size(); k++) {
+        if (row[k] != 0) {
+            continue;
+        }
+        const uint64_t* rows = context.nonzero.data() + (size_t) columns[k] * context.words;
+        for (unsigned int w=0; w<context.words; w++) {
+            if (history[w] & rows[w]) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// Rows of a dense system always have the same columns, so only their values are hashed
+bool sameColumns(RowView, RowView) {
+    return true;
+}
+
+size_t hashColumns(RowView) {
+    return 0;
+}
+
+// Rows of a sparse system have the same columns if they have the same nonzeros
+bool sameColumns(SparseRowView a, SparseRowView b) {
+    return a.size == b.size && std::equal(a.indices, a.indices + a.size, b.indices);
+}
+
+size_t hashColumns(SparseRowView row) {
+    size_t h = 0;
+    for (unsigned int k=0; k<row.size; k++) {
+        h ^= std::hash<unsigned int>()(row.indices[k]) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+// Same for a sparse row, whose nonzeros are given by the original variables. columns is sorted.
+unsigned int implicitlyEliminated(SparseRowView row, const uint64_t* history, std::vector<unsigned int>& columns, EliminationContext& context) {
+    unsigned int count = 0;
+    unsigned int k = 0;
+    for (unsigned int col : columns) {
+        while (k < row.size && row.indices[k] < col) {
+            k++;
+        }
+        if (k < row.size && row.indices[k] == col) {
+            continue;
+        }
+        const uint64_t* rows = context.nonzero.data() + (size_t) col * context.words;
+        for (unsigned int w=0; w<context.words; w++) {
+            if (history[w] & rows[w]) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// Writes the nonzeros of rowJ * scaleJ - rowI * scaleI except for column c to indices and values and returns their number
+unsigned int combineSparse(SparseRowView rowJ, double scaleJ, SparseRowView rowI, double scaleI, unsigned int c,
+        unsigned int* indices, double* values) {
+    unsigned int size = 0;
+    unsigned int p = 0;
+    unsigned int q = 0;
+    while (p < rowJ.size || q < rowI.size) {
+        unsigned int col;
+        double a = 0;
+        double b = 0;
+        if (q == rowI.size || (p < rowJ.size && rowJ.indices[p] < rowI.indices[q])) {
+            col = rowJ.indices[p];
+            a = rowJ.values[p++];
+        } else if (p == rowJ.size || rowI.indices[q] < rowJ.indices[p]) {
+            col = rowI.indices[q];
+            b = rowI.values[q++];
+        } else {
+            col = rowJ.indices[p];
+            a = rowJ.values[p++];
+            b = rowI.values[q++];
+        }
+        double value = combineValues(a, scaleJ, b, scaleI);
+        if (col != c && value != 0) {
+            indices[size] = col;
+            values[size] = value;
+            size++;
+        }
+    }
+    return size;
+}
+
+// Hash and equality of rows of a system after division by their scale. + 0.0 turns -0.0 into 0.0, so equal rows have
+// equal hashes.
+template <class Program>
+class NormalizedRows {
+public:
+    NormalizedRows(Program& lp, std::vector<double>& scale) : lp(&lp), scale(&scale) { }
+
+    size_t operator()(unsigned int i) const {
+        size_t h = hashColumns(lp->row(i));
+        for (double d : lp->row(i)) {
+            h ^= std::hash<double>()(d / (*scale)[i] + 0.0) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+
+    bool operator()(unsigned int i, unsigned int j) const {
+        auto a = lp->row(i);
+        auto b = lp->row(j);
+        if (!sameColumns(a, b)) {
+            return false;
+        }
+        for (unsigned int k=0; k<a.size; k++) {
+            if (a.values[k] / (*scale)[i] != b.values[k] / (*scale)[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Program* lp;
+    std::vector<double>* scale;
+};
+
+// Removes the rows with keep[i] == false and redundant rows from the next system: rows without nonzero coefficients
+// whose constraint is >= 0 and, if enabled, rows that are positive multiples of another one with a smaller or equal
+// (normalized) constraint and, with history pruning, a subset of their original rows
+template <class Program>
+void removeRedundantRows(NextSystem<Program>& next, std::vector<bool>& keep, EliminationContext& context, EliminationLevel& level) {
+    Program& lp = next.lp;
+    unsigned int rows = lp.getRowCount();
+    std::vector<double> scale(rows, 0);
+    NormalizedRows<Program> normalized(lp, scale);
+    std::unordered_map<unsigned int, unsigned int, NormalizedRows<Program>, NormalizedRows<Program>> seen(rows, normalized, normalized);
+    for (unsigned int i=0; i<rows; i++) {
+        if (!keep[i]) {
+            continue;
+        }
+        for (double d : lp.row(i)) {
+            scale[i] = std::max(scale[i], std::abs(d));
+        }
+        if (scale[i] == 0) {
+            // 0 <= b is always true for b >= 0, otherwise the row is the certificate of infeasibility
+            if (lp.constraint(i) >= 0) {
+                keep[i] = false;
+                level.redundant++;
+            }
+            continue;
+        }
+        if (!context.options.removeDuplicates) {
+            continue;
+        }
+
+        auto it = seen.find(i);
+        if (it == seen.end()) {
+            seen.emplace(i, i);
+            continue;
+        }
+        // A row is dropped for a duplicate that is at least as tight. With history pruning the duplicate also has to come
+        // from a subset of its original rows: otherwise the history criterion may later prune the combinations of the
+        // duplicate that the dropped row with the smaller history would have kept, and the elimination misses rows.
+        unsigned int other = it->second;
+        double constraint = lp.constraint(i) / scale[i];
+        double otherConstraint = lp.constraint(other) / scale[other];
+        const uint64_t* history = &next.history[(size_t) i * next.words];
+        const uint64_t* otherHistory = &next.history[(size_t) other * next.words];
+        bool pruning = context.options.historyPruning;
+        if (otherConstraint <= constraint && (!pruning || historySubset(otherHistory, history, next.words))) {
+            keep[i] = false;
+        } else if (constraint <= otherConstraint && (!pruning || historySubset(history, otherHistory, next.words))) {
+            keep[other] = false;
+            it->second = i;
+        } else {
+            continue;
+        }
+        level.duplicates++;
+    }
+
+    // Compact the origins and histories the same way as the rows
+    unsigned int kept = 0;
+    for (unsigned int i=0; i<rows; i++) {
+        if (keep[i]) {
+            next.first[kept] = next.first[i];
+            next.second[kept] = next.second[i];
+            std::copy(next.history.begin() + (size_t) i * next.words, next.history.begin() + (size_t) (i+1) * next.words,
+                next.history.begin() + (size_t) kept * next.words);
+            kept++;
+        }
+    }
+    next.first.resize(kept);
+    next.second.resize(kept);
+    next.history.resize((size_t) kept * next.words);
+    lp.keepRows(keep);
+}
+
+// Eliminates the variable chosen by the elimination order and solves the resulting system recursively. Row i of lp
+// comes from the original rows in history[i*words] ... history[(i+1)*words-1], column j of lp is the original variable
+// columns[j].
+FourierMotzkinResult eliminate(LinearProgram& lp, std::vector<uint64_t>& history, std::vector<unsigned int>& columns,
+        EliminationContext& context) {
 
     // Trivial case, check if "0 < a" for an a < 0
     if (lp.getColCount() == 0) {
@@ -40,90 +387,477 @@ FourierMotzkinResult fourierMotzkin(LinearProgram& lp) {
         return FourierMotzkinResult(true, certificate);
     }
 
-    // Create new LP
-    LinearProgram newLP(lp.getColCount()-1) ;
-    
-    // Indices where the first coefficient is <0, =0 and >0
+    ColumnSigns signs = columnSigns(lp);
+    unsigned int c = context.options.order(signs);
+    unsigned int cols = lp.getColCount();
+    unsigned int words = context.words;
+
+    // Indices where the coefficient of column c is <0, =0 and >0
     std::vector<unsigned int> lt0;
     std::vector<unsigned int> eq0;
     std::vector<unsigned int> gt0;
     for (unsigned int i=0; i<lp.getRowCount(); i++) {
-        if (lp.getMatValue(i, 0) < 0) {
+        if (lp.row(i)[c] < 0) {
             lt0.push_back(i);
-        } else if (lp.getMatValue(i, 0) > 0) {
+        } else if (lp.row(i)[c] > 0) {
             gt0.push_back(i);
         } else {
             eq0.push_back(i);
         }
     }
 
-    // Copy equations where the first coefficient is equal to 0
-    for (unsigned int i : eq0) {
-        std::vector<double> rowVals;
-        for (int j=1; j<lp.getColCount(); j++) {
-            rowVals.push_back(lp.getMatValue(i, j));
+    EliminationLevel level;
+    level.variable = columns[c];
+    level.rows = lp.getRowCount();
+    unsigned int eliminated = context.eliminated + 1;
+    std::vector<unsigned int> newColumns(columns);
+    newColumns.erase(newColumns.begin() + c);
+
+    // The combinations of lt0[a] are built into chunk a, in parallel and with one row of lt0 at a time per thread.
+    // Then the next level is allocated at its final size and the chunks are copied into it in order, after the copies of
+    // eq0. So the order of the rows does not depend on the number of threads.
+    unsigned int threads = context.pool != nullptr ? context.pool->size() : 1;
+    std::vector<CombinedRows> chunks(lt0.size());
+    std::vector<std::vector<double>> scratch(threads, std::vector<double>(cols-1));
+    std::vector<std::vector<uint64_t>> scratchHistory(threads, std::vector<uint64_t>(words));
+    // Each row is scaled by the reciprocal of its coefficient for column c, so the kernel needs no divisions
+    std::vector<double> ltScale(lt0.size());
+    std::vector<double> gtScale(gt0.size());
+    for (unsigned int a=0; a<lt0.size(); a++) {
+        ltScale[a] = 1 / lp.row(lt0[a])[c];
+    }
+    for (unsigned int b=0; b<gt0.size(); b++) {
+        gtScale[b] = 1 / lp.row(gt0[b])[c];
+    }
+    RowKernels& kernels = context.kernels;
+
+    std::atomic<unsigned int> nextRow(0);
+    std::function<void(unsigned int)> combine = [&](unsigned int t) {
+        double* values = scratch[t].data();
+        uint64_t* combined = scratchHistory[t].data();
+        for (unsigned int a = nextRow++; a < lt0.size(); a = nextRow++) {
+            unsigned int i = lt0[a];
+            const double* rowI = lp.row(i).values;
+            double scaleI = ltScale[a];
+            CombinedRows& chunk = chunks[a];
+            for (unsigned int b=0; b<gt0.size(); b++) {
+                unsigned int j = gt0[b];
+                const double* rowJ = lp.row(j).values;
+                double scaleJ = gtScale[b];
+                kernels.combine(values, rowJ, scaleJ, rowI, scaleI, c);
+                kernels.combine(values + c, rowJ + c + 1, scaleJ, rowI + c + 1, scaleI, cols - c - 1);
+                for (unsigned int w=0; w<words; w++) {
+                    combined[w] = history[(size_t) i * words + w] | history[(size_t) j * words + w];
+                }
+
+                // A row that comes from more than 1 + (explicitly and implicitly) eliminated variables original rows is
+                // implied by the others (Chernikov, Imbert)
+                if (context.options.historyPruning) {
+                    unsigned int size = historySize(combined, words);
+                    if (size > 1 + eliminated && size > 1 + eliminated + implicitlyEliminated(values, combined, newColumns, context)) {
+                        chunk.pruned++;
+                        continue;
+                    }
+                }
+                chunk.values.insert(chunk.values.end(), values, values + cols - 1);
+                chunk.constraints.push_back(combineValues(lp.constraint(j), scaleJ, lp.constraint(i), scaleI));
+                chunk.second.push_back(j);
+                chunk.history.insert(chunk.history.end(), combined, combined + words);
+            }
         }
-        newLP.addRow(rowVals, lp.getConstraint(i));
+    };
+    bool parallel = context.pool != nullptr && lt0.size() * gt0.size() * cols >= PARALLEL_THRESHOLD;
+    if (parallel) {
+        context.pool->run(combine);
+    } else {
+        combine(0);
+    }
+
+    // Place of the first row of each chunk in the next level
+    std::vector<size_t> offset(lt0.size() + 1, eq0.size());
+    for (unsigned int a=0; a<lt0.size(); a++) {
+        offset[a+1] = offset[a] + chunks[a].constraints.size();
+        level.redundant += chunks[a].pruned;
     }
-    // Construct new equations where the coeff. is < or > 0s
-    for (unsigned int i : lt0) {
-        for (unsigned int j : gt0) {
-            std::vector<double> rowVals;
-            for (unsigned int k=1; k<lp.getColCount(); k++) {
-                rowVals.push_back(lp.getMatValue(j, k)/lp.getMatValue(j, 0) - lp.getMatValue(i, k)/lp.getMatValue(i, 0));
+    size_t count = offset[lt0.size()];
+    NextSystem<LinearProgram> next(cols-1, words);
+    next.lp.resizeRows(count);
+    next.first.resize(count);
+    next.second.resize(count);
+    next.history.resize(count * words);
+
+    // Copy equations where the coefficient is equal to 0
+    for (unsigned int k=0; k<eq0.size(); k++) {
+        unsigned int i = eq0[k];
+        RowView row = lp.row(i);
+        RowView values = next.lp.row(k);
+        std::copy(row.begin(), row.begin() + c, values.begin());
+        std::copy(row.begin() + c + 1, row.end(), values.begin() + c);
+        next.lp.constraint(k) = lp.constraint(i);
+        next.first[k] = i;
+        next.second[k] = NO_ROW;
+        std::copy(history.begin() + (size_t) i * words, history.begin() + (size_t) (i+1) * words, next.history.begin() + (size_t) k * words);
+    }
+    nextRow = 0;
+    std::function<void(unsigned int)> place = [&](unsigned int) {
+        for (unsigned int a = nextRow++; a < lt0.size(); a = nextRow++) {
+            CombinedRows& chunk = chunks[a];
+            if (chunk.constraints.size() > 0) {
+                std::copy(chunk.values.begin(), chunk.values.end(), next.lp.row(offset[a]).begin());
+                std::copy(chunk.constraints.begin(), chunk.constraints.end(), &next.lp.constraint(offset[a]));
+                std::fill(next.first.begin() + offset[a], next.first.begin() + offset[a+1], lt0[a]);
+                std::copy(chunk.second.begin(), chunk.second.end(), next.second.begin() + offset[a]);
+                std::copy(chunk.history.begin(), chunk.history.end(), next.history.begin() + offset[a] * words);
             }
-            double constraint = lp.getConstraint(j)/lp.getMatValue(j, 0) - lp.getConstraint(i)/lp.getMatValue(i, 0);
-            newLP.addRow(rowVals, constraint);
+            chunk = CombinedRows();
         }
+    };
+    if (parallel) {
+        context.pool->run(place);
+    } else {
+        place(0);
     }
 
-    FourierMotzkinResult res = fourierMotzkin(newLP);
+    level.generated = eq0.size() + lt0.size() * gt0.size();
+    std::vector<bool> keep(count, true);
+    removeRedundantRows(next, keep, context, level);
+    level.kept = next.lp.getRowCount();
+    context.stats->levels.push_back(level);
+
+    context.eliminated = eliminated;
+    FourierMotzkinResult res = eliminate(next.lp, next.history, newColumns, context);
 
     // check if the lp is feasible
     if (res.feasible) {
-        std::vector<double> certificate;
-        certificate.push_back(0);
-
-        // append old certificate (already known variables)
-        certificate.insert(certificate.end(), res.certificate.begin(), res.certificate.end());
+        // old certificate (already known variables) with a 0 for the eliminated one
+        std::vector<double> certificate(res.certificate);
+        certificate.insert(certificate.begin() + c, 0);
 
         // Find a possible value for the next variable
         if (lt0.size() > 0) {
             double max = -INFINITY;
             double tmp = 0;
             for (unsigned int i : lt0) {
-                if ((tmp = -scalarMult(certificate, lp.getRow(i))/lp.getMatValue(i, 0) + lp.getConstraint(i)/lp.getMatValue(i, 0)) > max) {
+                if ((tmp = -scalarMult(certificate, lp.row(i))/lp.row(i)[c] + lp.constraint(i)/lp.row(i)[c]) > max) {
                     max = tmp;
                 }
             }
-            certificate[0] = max;
+            certificate[c] = max;
         } else if (gt0.size() > 0) {
             double min = INFINITY;
             double tmp = 0;
             for (unsigned int i : gt0) {
-                if ((tmp = -scalarMult(certificate, lp.getRow(i))/lp.getMatValue(i, 0) + lp.getConstraint(i)/lp.getMatValue(i, 0)) < min) {
+                if ((tmp = -scalarMult(certificate, lp.row(i))/lp.row(i)[c] + lp.constraint(i)/lp.row(i)[c]) < min) {
                     min = tmp;
                 }
             }
-            certificate[0] = min;
+            certificate[c] = min;
         }
 
         return FourierMotzkinResult(true, certificate);
     } else {
         std::vector<double> certificate(lp.getRowCount(), 0);
 
-        // Copy scalars for rows that have been copied
-        for (unsigned int i=0; i<eq0.size(); i++) {
-            certificate[eq0[i]] += res.certificate[i];
+        // Distribute the scalar of each row of the new LP onto the rows it has been copied or combined from
+        for (unsigned int k=0; k<next.first.size(); k++) {
+            if (next.second[k] == NO_ROW) {
+                certificate[next.first[k]] += res.certificate[k];
+            } else {
+                certificate[next.first[k]] -= res.certificate[k] / lp.row(next.first[k])[c];
+                certificate[next.second[k]] += res.certificate[k] / lp.row(next.second[k])[c];
+            }
+        }
+
+        return FourierMotzkinResult(false, certificate);
+    }
+}
+
+// Eliminates the variable chosen by the elimination order from a sparse system and solves the resulting system
+// recursively. Only variables with nonzero coefficients are eliminated, the columns keep their original index. Row i of
+// lp comes from the original rows in history[i*words] ... history[(i+1)*words-1], columns are the variables that have
+// not been eliminated yet in increasing order.
+FourierMotzkinResult eliminate(SparseLinearProgram& lp, std::vector<uint64_t>& history, std::vector<unsigned int>& columns,
+        EliminationContext& context) {
+
+    // Signs of the variables that still have nonzero coefficients
+    std::vector<long long> lt(lp.getColCount(), 0);
+    std::vector<long long> gt(lp.getColCount(), 0);
+    size_t longestRow = 0;
+    for (unsigned int i=0; i<lp.getRowCount(); i++) {
+        SparseRowView row = lp.row(i);
+        for (unsigned int k=0; k<row.size; k++) {
+            lt[row.indices[k]] += row.values[k] < 0;
+            gt[row.indices[k]] += row.values[k] > 0;
+        }
+        longestRow = std::max(longestRow, (size_t) row.size);
+    }
+    ColumnSigns signs;
+    std::vector<unsigned int> candidates;
+    for (unsigned int col : columns) {
+        if (lt[col] + gt[col] > 0) {
+            candidates.push_back(col);
+            signs.lt.push_back(lt[col]);
+            signs.gt.push_back(gt[col]);
         }
+    }
 
-        for (unsigned int i=0; i<lt0.size(); i++) {
-            for (unsigned int j=0; j<gt0.size(); j++) {
-                certificate[lt0[i]] -= res.certificate[i*gt0.size() + j + eq0.size()] / lp.getMatValue(lt0[i], 0);
-                certificate[gt0[j]] += res.certificate[i*gt0.size() + j + eq0.size()] / lp.getMatValue(gt0[j], 0);
+    // Trivial case, all coefficients are zero: check if "0 < a" for an a < 0, otherwise all variables can be 0
+    if (candidates.empty()) {
+        for (unsigned int i=0; i<lp.getRowCount(); i++) {
+            if (lp.getConstraint(i) < 0) {
+                std::vector<double> certificate(lp.getRowCount(), 0);
+                certificate[i] = 1;
+
+                return FourierMotzkinResult(false, certificate);
+            }
+        }
+        std::vector<double> certificate(lp.getColCount(), 0);
+
+        return FourierMotzkinResult(true, certificate);
+    }
+
+    unsigned int c = candidates[context.options.order(signs)];
+    unsigned int words = context.words;
+
+    // Coefficient of each row for column c and indices where it is <0, =0 and >0
+    std::vector<double> coefficient(lp.getRowCount(), 0);
+    std::vector<unsigned int> lt0;
+    std::vector<unsigned int> eq0;
+    std::vector<unsigned int> gt0;
+    for (unsigned int i=0; i<lp.getRowCount(); i++) {
+        SparseRowView row = lp.row(i);
+        const unsigned int* it = std::lower_bound(row.indices, row.indices + row.size, c);
+        if (it != row.indices + row.size && *it == c) {
+            coefficient[i] = row.values[it - row.indices];
+        }
+        if (coefficient[i] < 0) {
+            lt0.push_back(i);
+        } else if (coefficient[i] > 0) {
+            gt0.push_back(i);
+        } else {
+            eq0.push_back(i);
+        }
+    }
+
+    EliminationLevel level;
+    level.variable = c;
+    level.rows = lp.getRowCount();
+    unsigned int eliminated = context.eliminated + 1;
+    std::vector<unsigned int> newColumns(columns);
+    newColumns.erase(std::find(newColumns.begin(), newColumns.end(), c));
+
+    // The combinations of lt0[a] are built into chunk a like in the dense elimination, a combination has at most the
+    // nonzeros of both rows
+    unsigned int threads = context.pool != nullptr ? context.pool->size() : 1;
+    std::vector<SparseCombinedRows> chunks(lt0.size(), SparseCombinedRows(lp.getColCount()));
+    std::vector<std::vector<unsigned int>> scratchIndices(threads, std::vector<unsigned int>(2 * longestRow));
+    std::vector<std::vector<double>> scratch(threads, std::vector<double>(2 * longestRow));
+    std::vector<std::vector<uint64_t>> scratchHistory(threads, std::vector<uint64_t>(words));
+    // Reciprocals of the coefficients for column c, like in the dense elimination
+    std::vector<double> ltScale(lt0.size());
+    std::vector<double> gtScale(gt0.size());
+    for (unsigned int a=0; a<lt0.size(); a++) {
+        ltScale[a] = 1 / coefficient[lt0[a]];
+    }
+    for (unsigned int b=0; b<gt0.size(); b++) {
+        gtScale[b] = 1 / coefficient[gt0[b]];
+    }
+
+    std::atomic<unsigned int> nextRow(0);
+    std::function<void(unsigned int)> combine = [&](unsigned int t) {
+        unsigned int* indices = scratchIndices[t].data();
+        double* values = scratch[t].data();
+        uint64_t* combined = scratchHistory[t].data();
+        for (unsigned int a = nextRow++; a < lt0.size(); a = nextRow++) {
+            unsigned int i = lt0[a];
+            SparseRowView rowI = lp.row(i);
+            double scaleI = ltScale[a];
+            SparseCombinedRows& chunk = chunks[a];
+            for (unsigned int b=0; b<gt0.size(); b++) {
+                unsigned int j = gt0[b];
+                SparseRowView rowJ = lp.row(j);
+                double scaleJ = gtScale[b];
+                unsigned int size = combineSparse(rowJ, scaleJ, rowI, scaleI, c, indices, values);
+                for (unsigned int w=0; w<words; w++) {
+                    combined[w] = history[(size_t) i * words + w] | history[(size_t) j * words + w];
+                }
+
+                // Same criterion as in the dense elimination
+                if (context.options.historyPruning) {
+                    unsigned int historyCount = historySize(combined, words);
+                    if (historyCount > 1 + eliminated
+                            && historyCount > 1 + eliminated + implicitlyEliminated(SparseRowView(indices, values, size), combined, newColumns, context)) {
+                        chunk.pruned++;
+                        continue;
+                    }
+                }
+                chunk.rows.addRow(indices, values, size, combineValues(lp.constraint(j), scaleJ, lp.constraint(i), scaleI));
+                chunk.second.push_back(j);
+                chunk.history.insert(chunk.history.end(), combined, combined + words);
+            }
+        }
+    };
+    size_t averageRow = lp.getNonzeroCount() / lp.getRowCount() + 1;
+    if (context.pool != nullptr && lt0.size() * gt0.size() * averageRow >= PARALLEL_THRESHOLD) {
+        context.pool->run(combine);
+    } else {
+        combine(0);
+    }
+
+    // Copy the rows where the coefficient is equal to 0, then the combinations in the order of lt0
+    size_t count = eq0.size();
+    size_t nonzeros = 0;
+    for (unsigned int i : eq0) {
+        nonzeros += lp.row(i).size;
+    }
+    for (SparseCombinedRows& chunk : chunks) {
+        count += chunk.rows.getRowCount();
+        nonzeros += chunk.rows.getNonzeroCount();
+        level.redundant += chunk.pruned;
+    }
+    NextSystem<SparseLinearProgram> next(lp.getColCount(), words);
+    next.lp.reserve(count, nonzeros);
+    next.first.reserve(count);
+    next.second.reserve(count);
+    next.history.reserve(count * words);
+    for (unsigned int i : eq0) {
+        SparseRowView row = lp.row(i);
+        next.lp.addRow(row.indices, row.values, row.size, lp.constraint(i));
+        next.first.push_back(i);
+        next.second.push_back(NO_ROW);
+        next.history.insert(next.history.end(), history.begin() + (size_t) i * words, history.begin() + (size_t) (i+1) * words);
+    }
+    for (unsigned int a=0; a<lt0.size(); a++) {
+        SparseCombinedRows& chunk = chunks[a];
+        next.lp.addRows(chunk.rows);
+        next.first.insert(next.first.end(), chunk.second.size(), lt0[a]);
+        next.second.insert(next.second.end(), chunk.second.begin(), chunk.second.end());
+        next.history.insert(next.history.end(), chunk.history.begin(), chunk.history.end());
+        chunk = SparseCombinedRows(lp.getColCount());
+    }
+
+    level.generated = eq0.size() + lt0.size() * gt0.size();
+    std::vector<bool> keep(count, true);
+    removeRedundantRows(next, keep, context, level);
+    level.kept = next.lp.getRowCount();
+    context.stats->levels.push_back(level);
+
+    context.eliminated = eliminated;
+    FourierMotzkinResult res = eliminate(next.lp, next.history, newColumns, context);
+
+    // check if the lp is feasible
+    if (res.feasible) {
+        // The variables of the next system are known, variable c is still 0
+        std::vector<double> certificate(res.certificate);
+
+        // Find a possible value for the next variable
+        if (lt0.size() > 0) {
+            double max = -INFINITY;
+            double tmp = 0;
+            for (unsigned int i : lt0) {
+                if ((tmp = -scalarMult(certificate, lp.row(i))/coefficient[i] + lp.constraint(i)/coefficient[i]) > max) {
+                    max = tmp;
+                }
+            }
+            certificate[c] = max;
+        } else {
+            double min = INFINITY;
+            double tmp = 0;
+            for (unsigned int i : gt0) {
+                if ((tmp = -scalarMult(certificate, lp.row(i))/coefficient[i] + lp.constraint(i)/coefficient[i]) < min) {
+                    min = tmp;
+                }
+            }
+            certificate[c] = min;
+        }
+
+        return FourierMotzkinResult(true, certificate);
+    } else {
+        std::vector<double> certificate(lp.getRowCount(), 0);
+
+        // Distribute the scalar of each row of the new LP onto the rows it has been copied or combined from
+        for (unsigned int k=0; k<next.first.size(); k++) {
+            if (next.second[k] == NO_ROW) {
+                certificate[next.first[k]] += res.certificate[k];
+            } else {
+                certificate[next.first[k]] -= res.certificate[k] / coefficient[next.first[k]];
+                certificate[next.second[k]] += res.certificate[k] / coefficient[next.second[k]];
             }
         }
 
         return FourierMotzkinResult(false, certificate);
     }
-}
\ No newline at end of file
+}
+
+// Fourier motzkin elimination algorithm to find a feasible solution of an LP or find a certificate that the LP is infeasible
+FourierMotzkinResult fourierMotzkin(LinearProgram& lp, FourierMotzkinOptions& options, FourierMotzkinStats& stats) {
+    EliminationContext context;
+    context.options = options;
+    context.stats = &stats;
+    context.kernels = rowKernels();
+
+    // At the start every row is its own history
+    unsigned int rows = lp.getRowCount();
+    context.words = (rows + 63) / 64;
+    std::vector<uint64_t> history((size_t) rows * context.words, 0);
+    context.nonzero.assign((size_t) lp.getColCount() * context.words, 0);
+    std::vector<unsigned int> columns(lp.getColCount());
+    for (unsigned int j=0; j<lp.getColCount(); j++) {
+        columns[j] = j;
+    }
+    for (unsigned int i=0; i<rows; i++) {
+        history[(size_t) i * context.words + i / 64] |= 1ULL << (i % 64);
+        for (unsigned int j=0; j<lp.getColCount(); j++) {
+            if (lp.getMatValue(i, j) != 0) {
+                context.nonzero[(size_t) j * context.words + i / 64] |= 1ULL << (i % 64);
+            }
+        }
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (options.threads > 1) {
+        pool.reset(new ThreadPool(options.threads));
+        context.pool = pool.get();
+    }
+
+    return eliminate(lp, history, columns, context);
+}
+
+// Fourier motzkin elimination on the nonzero coefficients of a sparse LP
+FourierMotzkinResult fourierMotzkin(SparseLinearProgram& lp, FourierMotzkinOptions& options, FourierMotzkinStats& stats) {
+    EliminationContext context;
+    context.options = options;
+    context.stats = &stats;
+    context.kernels = rowKernels();
+
+    // At the start every row is its own history
+    unsigned int rows = lp.getRowCount();
+    context.words = (rows + 63) / 64;
+    std::vector<uint64_t> history((size_t) rows * context.words, 0);
+    context.nonzero.assign((size_t) lp.getColCount() * context.words, 0);
+    std::vector<unsigned int> columns(lp.getColCount());
+    for (unsigned int j=0; j<lp.getColCount(); j++) {
+        columns[j] = j;
+    }
+    for (unsigned int i=0; i<rows; i++) {
+        history[(size_t) i * context.words + i / 64] |= 1ULL << (i % 64);
+        SparseRowView row = lp.row(i);
+        for (unsigned int k=0; k<row.size; k++) {
+            context.nonzero[(size_t) row.indices[k] * context.words + i / 64] |= 1ULL << (i % 64);
+        }
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (options.threads > 1) {
+        pool.reset(new ThreadPool(options.threads));
+        context.pool = pool.get();
+    }
+
+    return eliminate(lp, history, columns, context);
+}
+
+FourierMotzkinResult fourierMotzkin(LinearProgram& lp) {
+    FourierMotzkinOptions options;
+    FourierMotzkinStats stats;
+    return fourierMotzkin(lp, options, stats);
+}
@@ -2,16 +2,69 @@
 #define FOURIERMOTZKIN_H
 
 #include "LinearProgram.h"
+#include "SparseLinearProgram.h"
 
-double scalarMult(std::vector<double> a, std::vector<double> b);
+#include <functional>
+#include <string>
+
+double scalarMult(const double* a, const double* b, unsigned int size);
+double scalarMult(const std::vector<double>& a, const std::vector<double>& b);
+double scalarMult(const std::vector<double>& a, RowView b);
+double scalarMult(const std::vector<double>& a, SparseRowView b);
 // Contains the result of the Fourier Motzkin elimination
 class FourierMotzkinResult {
 public:
     FourierMotzkinResult(bool feasible, std::vector<double>& certificate) : feasible(feasible), certificate(certificate) { }
     bool feasible;
-    std::vector<double> certificate;    
+    std::vector<double> certificate;
+};
+
+// Number of rows with a coefficient < 0 and > 0 for each column of a system
+class ColumnSigns {
+public:
+    std::vector<long long> lt;
+    std::vector<long long> gt;
+};
+
+// Chooses the column that is eliminated next from the signs of the columns of the system
+typedef std::function<unsigned int(ColumnSigns&)> EliminationOrder;
+
+unsigned int fixedOrder(ColumnSigns& signs); // always the first remaining variable
+unsigned int minFillOrder(ColumnSigns& signs); // the variable that minimizes |lt0| * |gt0| - |lt0| - |gt0|
+// Parses the name of an elimination order as given on the command line (fixed, fill)
+EliminationOrder parseEliminationOrder(std::string name);
+
+// Controls the order of the eliminations and which redundant rows are removed after each elimination step
+class FourierMotzkinOptions {
+public:
+    bool removeDuplicates = true; // rows that are positive multiples of another row with a smaller or equal constraint
+                                  // (and, with history pruning, a subset of their original rows)
+    bool historyPruning = true; // rows that are redundant by the Chernikov/Imbert criterion on the original rows they come from
+    EliminationOrder order = fixedOrder;
+    unsigned int threads = 1; // threads that combine the rows of each level
+};
+
+// Row counts of one elimination step
+class EliminationLevel {
+public:
+    unsigned int variable = 0; // original index of the eliminated variable
+    unsigned int rows = 0; // rows of the system the variable is eliminated from
+    unsigned int generated = 0; // rows of the next system before pruning
+    unsigned int redundant = 0; // removed by the history criterion or because all coefficients are zero
+    unsigned int duplicates = 0; // removed as duplicates
+    unsigned int kept = 0; // rows of the next system
+};
+
+// Statistics of the Fourier Motzkin elimination, one entry per eliminated variable
+class FourierMotzkinStats {
+public:
+    std::vector<EliminationLevel> levels;
 };
 
 FourierMotzkinResult fourierMotzkin(LinearProgram& lp);
+FourierMotzkinResult fourierMotzkin(LinearProgram& lp, FourierMotzkinOptions& options, FourierMotzkinStats& stats);
+// Same elimination on the nonzero coefficients only. Variables without nonzero coefficients are not eliminated but set to
+// 0, so the levels of the statistics only cover the others.
+FourierMotzkinResult fourierMotzkin(SparseLinearProgram& lp, FourierMotzkinOptions& options, FourierMotzkinStats& stats);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,32 +1,37 @@
 /* Fourier Motzkin elimination from assignment sheet 1 */
 
 #include "LinearProgram.h"
+#include "SparseLinearProgram.h"
 #include "fouriermotzkin.h"
+#include "simplex.h"
+#include "RowKernels.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <vector>
 
-// Check certificate for validity
-bool checkCertificate(LinearProgram& lp, FourierMotzkinResult res, double eps) {
+// Check certificate for validity, a feasible point may exceed each constraint by at most slack
+bool checkCertificate(LinearProgram& lp, FourierMotzkinResult res, double eps, double slack) {
 	if (res.feasible) {
 		for (unsigned int i=0; i<lp.getRowCount(); i++) {
             double sum = scalarMult(res.certificate, lp.getRow(i));
-            if (sum > lp.getConstraint(i)) {
+            if (sum > lp.getConstraint(i) + slack) {
                 return false;
             }
         }
         return true;
 	} else {
-        // Check if the row of the matrix sum up to zero (with an error <= eps)
+        // Check if the row of the matrix sum up to zero (with an error <= eps), the column sums are accumulated row by row
+        std::vector<double> sums(lp.getColCount(), 0);
+        for (unsigned int i=0; i<lp.getRowCount(); i++) {
+            rowKernels().axpy(sums.data(), res.certificate[i], lp.row(i).values, lp.getColCount());
+        }
         for (unsigned int j=0; j<lp.getColCount(); j++) {
-            double sum = 0;
-            for (unsigned int i=0; i<lp.getRowCount(); i++) {
-                sum += res.certificate[i] * lp.getMatValue(i, j);
-            }
-
-            if (abs(sum) > eps) {
+            if (std::abs(sums[j]) > eps) {
                 return false;
             }
         }
@@ -44,22 +49,174 @@ bool checkCertificate(LinearProgram& lp, FourierMotzkinResult res, double eps) {
     }
 }
 
+// Check certificate of a sparse LP for validity, a feasible point may exceed each constraint by at most slack
+bool checkCertificate(SparseLinearProgram& lp, FourierMotzkinResult res, double eps, double slack) {
+    if (res.feasible) {
+        for (unsigned int i=0; i<lp.getRowCount(); i++) {
+            if (scalarMult(res.certificate, lp.getRow(i)) > lp.getConstraint(i) + slack) {
+                return false;
+            }
+        }
+        return true;
+    } else {
+        // Check if the row of the matrix sum up to zero (with an error <= eps), the column sums are accumulated row by row
+        std::vector<double> sums(lp.getColCount(), 0);
+        double sum = 0;
+        for (unsigned int i=0; i<lp.getRowCount(); i++) {
+            SparseRowView row = lp.row(i);
+            for (unsigned int k=0; k<row.size; k++) {
+                sums[row.indices[k]] += res.certificate[i] * row.values[k];
+            }
+            sum += res.certificate[i] * lp.getConstraint(i);
+        }
+        for (unsigned int j=0; j<lp.getColCount(); j++) {
+            if (std::abs(sums[j]) > eps) {
+                return false;
+            }
+        }
+
+        return sum < 0;
+    }
+}
+
+// Prints the solution or the certificate of infeasibility and checks it
+template <class Program>
+void printResult(Program& lp, FourierMotzkinResult& res, double slack) {
+    if (res.feasible) {
+        for (double d : res.certificate) {
+            std::cout << d << " ";
+        }
+        std::cout << std::endl;
+    } else {
+        std::cout << "empty " << std::endl;
+        for (double d : res.certificate) {
+            std::cout << d << " ";
+        }
+    }
+
+    std::cout << std::endl;
+
+    // validity check
+    if (checkCertificate(lp, res, 1e-8, slack)) {
+        std::cout << "Validity check passed" << std::endl;
+    } else {
+        std::cout << "Validity check failed" << std::endl;
+    }
+}
+
+// Solves lp by Fourier Motzkin elimination
+template <class Program>
+void solve(Program& lp, FourierMotzkinOptions& options, bool printStats) {
+    FourierMotzkinStats stats;
+    FourierMotzkinResult res = fourierMotzkin(lp, options, stats);
+
+    if (printStats) {
+        for (EliminationLevel& level : stats.levels) {
+            std::cerr << "variable " << level.variable << ": " << level.rows << " rows, " << level.generated << " generated, "
+                << level.redundant << " redundant, " << level.duplicates << " duplicates, " << level.kept << " kept" << std::endl;
+        }
+    }
+
+    printResult(lp, res, 0);
+}
+
+// Solves lp with the simplex engine, which also maximizes the objective function
+template <class Program>
+void solveSimplex(Program& lp, bool printStats) {
+    SimplexStats stats;
+    FourierMotzkinResult res = simplex(lp, stats);
+
+    if (printStats) {
+        std::cerr << "phase 1: " << stats.phase1Pivots << " pivots, phase 2: " << stats.phase2Pivots << " pivots" << std::endl;
+        if (res.feasible) {
+            std::cerr << "objective value " << stats.objective << (stats.unbounded ? ", unbounded" : "") << std::endl;
+        }
+    }
+
+    // The point is read off the final tableau, so constraints that are tight at the vertex may be exceeded by rounding
+    printResult(lp, res, 1e-8);
+}
+
 // main function
 int main(int argc, char** argv) {
     std::string outputfile = "";
     std::string filename = "";
     bool filenameSpecified = false;
     bool outputfileSpecified = false;
+    bool printStats = false;
+    bool sparse = false;
+    bool sparseInput = false;
+    bool useSimplex = false;
+    FourierMotzkinOptions options;
     for (int i=1; i<argc; i++) {
         if (argv[i][0] == '-') {
+            char flag = argv[i][1];
             // Output file can be specified
-            if (argv[i][1] == 'o') {
+            if (flag == 'o') {
                 if (i+1 < argc) {
                     outputfile = std::string(argv[i+1]);
                     outputfileSpecified = true;
                     i++;
                 }
             }
+            // Keeps all rows instead of removing redundant ones after each elimination step
+            if (flag == 'n') {
+                options.removeDuplicates = false;
+                options.historyPruning = false;
+            }
+            // Order in which the variables are eliminated (fixed, fill)
+            if (flag == 'e') {
+                if (i+1 < argc) {
+                    options.order = parseEliminationOrder(std::string(argv[i+1]));
+                    i++;
+                }
+            }
+            // Number of threads that combine the rows of each elimination step
+            if (flag == 't') {
+                if (i+1 < argc) {
+                    options.threads = std::max(1, std::atoi(argv[i+1]));
+                    i++;
+                }
+            }
+            // Row kernels can be specified (auto, scalar, avx2, avx512)
+            if (flag == 'k') {
+                if (i+1 < argc) {
+                    rowKernels() = selectRowKernels(std::string(argv[i+1]));
+                    i++;
+                }
+            }
+            // Only the nonzero coefficients are stored and combined
+            if (flag == 's') {
+                sparse = true;
+            }
+            // Format of the input file can be specified (dense, sparse), sparse files are eliminated sparse
+            if (flag == 'f') {
+                if (i+1 < argc) {
+                    std::string format(argv[i+1]);
+                    if (format == "sparse") {
+                        sparseInput = true;
+                    } else if (format != "dense") {
+                        throw std::invalid_argument("Unknown input format " + format);
+                    }
+                    i++;
+                }
+            }
+            // Algorithm can be specified (fm, simplex)
+            if (flag == 'a') {
+                if (i+1 < argc) {
+                    std::string algorithm(argv[i+1]);
+                    if (algorithm == "simplex") {
+                        useSimplex = true;
+                    } else if (algorithm != "fm") {
+                        throw std::invalid_argument("Unknown algorithm " + algorithm);
+                    }
+                    i++;
+                }
+            }
+            // Row counts of each elimination step or the pivots of the simplex are printed to stderr
+            if (flag == 'v') {
+                printStats = true;
+            }
         } else {
             filename = argv[i];
             filenameSpecified = true;
@@ -71,29 +228,23 @@ int main(int argc, char** argv) {
         return 0;
     }
     
-    LinearProgram lp(filename);
-
-    FourierMotzkinResult res = fourierMotzkin(lp);
-
-    if (res.feasible) {
-        for (double d : res.certificate) {
-            std::cout << d << " ";
-        }
-        std::cout << std::endl;
-    } else {
-        std::cout << "empty " << std::endl;
-        for (double d : res.certificate) {
-            std::cout << d << " ";
+    if (sparseInput) {
+        SparseLinearProgram lp(filename);
+        if (useSimplex) {
+            solveSimplex(lp, printStats);
+        } else {
+            solve(lp, options, printStats);
         }
-    }
-
-    std::cout << std::endl;
-
-    // validity check
-    if (checkCertificate(lp, res, 1e-8)) {
-        std::cout << "Validity check passed" << std::endl;
+    } else if (useSimplex) {
+        LinearProgram lp(filename);
+        solveSimplex(lp, printStats);
+    } else if (sparse) {
+        LinearProgram dense(filename);
+        SparseLinearProgram lp(dense);
+        solve(lp, options, printStats);
     } else {
-        std::cout << "Validity check failed" << std::endl;
+        LinearProgram lp(filename);
+        solve(lp, options, printStats);
     }
 
     return 0;
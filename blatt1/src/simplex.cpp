@@ -0,0 +1,229 @@
+#include "simplex.h"
+#include "LinearProgram.h"
+#include "SparseLinearProgram.h"
+#include "RowKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Reduced costs and pivot elements with a smaller absolute value are treated as zero
+const double SIMPLEX_EPS = 1e-9;
+// Degenerate pivots in a row after which the entering variable is chosen by Bland's rule, so the simplex cannot cycle
+const unsigned int DEGENERATE_LIMIT = 50;
+
+// Writes a row of the matrix into a dense row of the tableau, which is zero before
+void copyRow(RowView source, double* target) {
+    std::copy(source.begin(), source.end(), target);
+}
+
+void copyRow(SparseRowView source, double* target) {
+    for (unsigned int k=0; k<source.size; k++) {
+        target[source.indices[k]] = source.values[k];
+    }
+}
+
+// Tableau of A x + s - t * 1 = b with the free variables x, the slacks s >= 0 and the artificial variable t >= 0 of the
+// first phase. Rows 0 ... m-1 are the constraints, row m the reduced costs of the current objective. The last column
+// holds the values of the basic variables, and minus the objective value in row m.
+class SimplexTableau {
+public:
+    template <class Program>
+    SimplexTableau(Program& lp) : rows(lp.getRowCount()), vars(lp.getColCount()), width(vars + rows + 2),
+            values((size_t) (rows + 1) * width, 0), basis(rows), basic(vars + rows + 1, false), allowed(vars + rows + 1, true) {
+        for (unsigned int i=0; i<rows; i++) {
+            copyRow(lp.row(i), row(i));
+            row(i)[vars + i] = 1;
+            row(i)[artificial()] = -1;
+            row(i)[width - 1] = lp.constraint(i);
+            basis[i] = vars + i;
+            basic[vars + i] = true;
+        }
+    }
+
+    double* row(unsigned int index) {
+        return values.data() + (size_t) index * width;
+    }
+    double* objective() {
+        return row(rows);
+    }
+    unsigned int artificial() {
+        return vars + rows;
+    }
+    bool isFree(unsigned int var) {
+        return var < vars;
+    }
+    // Value of a variable in the current basic solution
+    double value(unsigned int var) {
+        for (unsigned int i=0; i<rows; i++) {
+            if (basis[i] == var) {
+                return row(i)[width - 1];
+            }
+        }
+        return 0;
+    }
+
+    unsigned int rows;
+    unsigned int vars;
+    unsigned int width;
+    std::vector<double> values;
+    std::vector<unsigned int> basis; // basic variable of each row
+    std::vector<bool> basic;
+    std::vector<bool> allowed; // variables that may enter the basis
+};
+
+// Makes var the basic variable of row r
+void pivot(SimplexTableau& tab, unsigned int r, unsigned int var) {
+    RowKernels& kernels = rowKernels();
+    double* pivotRow = tab.row(r);
+    double scale = 1 / pivotRow[var];
+    for (unsigned int k=0; k<tab.width; k++) {
+        pivotRow[k] *= scale;
+    }
+    pivotRow[var] = 1;
+    for (unsigned int i=0; i<=tab.rows; i++) {
+        double* target = tab.row(i);
+        double factor = target[var];
+        if (i != r && factor != 0) {
+            kernels.axpy(target, -factor, pivotRow, tab.width);
+            target[var] = 0;
+        }
+    }
+    tab.basic[tab.basis[r]] = false;
+    tab.basic[var] = true;
+    tab.basis[r] = var;
+}
+
+// Pivots until the reduced costs show that the current basis is optimal (returns true) or a variable can grow without
+// bound (returns false). Free variables enter the basis in the direction of their reduced cost and never leave it.
+bool optimize(SimplexTableau& tab, unsigned int& pivots) {
+    unsigned int degenerate = 0;
+    double* costs = tab.objective();
+    while (true) {
+        // Entering variable: the largest improvement, or the first one once the simplex stalls
+        bool bland = degenerate >= DEGENERATE_LIMIT;
+        unsigned int entering = tab.basic.size();
+        double best = SIMPLEX_EPS;
+        for (unsigned int j=0; j<tab.basic.size(); j++) {
+            if (tab.basic[j] || !tab.allowed[j]) {
+                continue;
+            }
+            double gain = tab.isFree(j) ? std::abs(costs[j]) : costs[j];
+            if (gain > best) {
+                entering = j;
+                best = gain;
+                if (bland) {
+                    break;
+                }
+            }
+        }
+        if (entering == tab.basic.size()) {
+            return true;
+        }
+        double direction = costs[entering] > 0 ? 1 : -1;
+
+        // Leaving variable: the first basic variable that drops to zero, ties go to the smaller variable
+        unsigned int leaving = tab.rows;
+        double ratio = INFINITY;
+        for (unsigned int i=0; i<tab.rows; i++) {
+            double coefficient = direction * tab.row(i)[entering];
+            if (tab.isFree(tab.basis[i]) || coefficient <= SIMPLEX_EPS) {
+                continue;
+            }
+            double step = tab.row(i)[tab.width - 1] / coefficient;
+            if (step < ratio || (step == ratio && tab.basis[i] < tab.basis[leaving])) {
+                leaving = i;
+                ratio = step;
+            }
+        }
+        if (leaving == tab.rows) {
+            return false;
+        }
+
+        degenerate = ratio <= SIMPLEX_EPS ? degenerate + 1 : 0;
+        pivot(tab, leaving, entering);
+        pivots++;
+    }
+}
+
+// Simplex algorithm to find an optimal solution of an LP or find a certificate that the LP is infeasible
+template <class Program>
+FourierMotzkinResult solveSimplex(Program& lp, SimplexStats& stats) {
+    SimplexTableau tab(lp);
+    unsigned int rows = tab.rows;
+    unsigned int t = tab.artificial();
+
+    // Phase 1: maximize -t. With t = -min b all slacks are >= 0, so t enters the basis in the row of the smallest
+    // constraint.
+    tab.objective()[t] = -1;
+    unsigned int smallest = 0;
+    for (unsigned int i=0; i<rows; i++) {
+        if (lp.constraint(i) < lp.constraint(smallest)) {
+            smallest = i;
+        }
+    }
+    if (rows > 0 && lp.constraint(smallest) < 0) {
+        pivot(tab, smallest, t);
+        optimize(tab, stats.phase1Pivots);
+
+        if (tab.value(t) > SIMPLEX_EPS) {
+            // The duals y = -(reduced costs of the slacks) satisfy y >= 0, y^T A = 0 and y^T b = -t < 0
+            std::vector<double> certificate(rows);
+            for (unsigned int i=0; i<rows; i++) {
+                certificate[i] = std::max(0.0, -tab.objective()[tab.vars + i]);
+            }
+
+            return FourierMotzkinResult(false, certificate);
+        }
+    }
+
+    // t is 0 now. If it is still basic, it is replaced by any variable with a nonzero coefficient in its row, otherwise
+    // the row is zero and t stays 0.
+    for (unsigned int i=0; i<rows; i++) {
+        if (tab.basis[i] != t) {
+            continue;
+        }
+        for (unsigned int j=0; j<t; j++) {
+            if (!tab.basic[j] && std::abs(tab.row(i)[j]) > SIMPLEX_EPS) {
+                pivot(tab, i, j);
+                break;
+            }
+        }
+    }
+    tab.allowed[t] = false;
+
+    // Phase 2: reduced costs of the objective function for the feasible basis
+    double* costs = tab.objective();
+    std::fill(costs, costs + tab.width, 0);
+    for (unsigned int j=0; j<tab.vars; j++) {
+        costs[j] = lp.getObjectiveValue(j);
+    }
+    for (unsigned int i=0; i<rows; i++) {
+        unsigned int var = tab.basis[i];
+        if (costs[var] != 0) {
+            rowKernels().axpy(costs, -costs[var], tab.row(i), tab.width);
+        }
+    }
+    stats.unbounded = !optimize(tab, stats.phase2Pivots);
+
+    std::vector<double> point(tab.vars, 0);
+    for (unsigned int i=0; i<rows; i++) {
+        if (tab.isFree(tab.basis[i])) {
+            point[tab.basis[i]] = tab.row(i)[tab.width - 1];
+        }
+    }
+    stats.objective = 0;
+    for (unsigned int j=0; j<tab.vars; j++) {
+        stats.objective += lp.getObjectiveValue(j) * point[j];
+    }
+
+    return FourierMotzkinResult(true, point);
+}
+
+FourierMotzkinResult simplex(LinearProgram& lp, SimplexStats& stats) {
+    return solveSimplex(lp, stats);
+}
+
+FourierMotzkinResult simplex(SparseLinearProgram& lp, SimplexStats& stats) {
+    return solveSimplex(lp, stats);
+}
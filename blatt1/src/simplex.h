@@ -0,0 +1,24 @@
+#ifndef SIMPLEX_H
+#define SIMPLEX_H
+
+#include "LinearProgram.h"
+#include "SparseLinearProgram.h"
+#include "fouriermotzkin.h"
+
+// Outcome of the simplex engine besides the point or certificate
+class SimplexStats {
+public:
+    unsigned int phase1Pivots = 0; // pivots to find a feasible basis
+    unsigned int phase2Pivots = 0; // pivots to optimize the objective function
+    bool unbounded = false; // the objective function is unbounded, the point is the last feasible basis
+    double objective = 0; // value of the objective function at the point
+};
+
+// Two-phase primal simplex on a dense tableau that maximizes the objective function of lp subject to A x <= b, with x
+// free. Returns an optimal point like fourierMotzkin returns a feasible one, or a Farkas certificate y >= 0 with
+// y^T A = 0 and y^T b < 0 if there is no feasible point.
+FourierMotzkinResult simplex(LinearProgram& lp, SimplexStats& stats);
+// Same for a sparse LP, whose rows are written into the dense tableau
+FourierMotzkinResult simplex(SparseLinearProgram& lp, SimplexStats& stats);
+
+#endif
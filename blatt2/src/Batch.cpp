@@ -0,0 +1,162 @@
+/* Solves many instances concurrently */
+#include "Batch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Gets the part of a path behind the last slash
+std::string base_name(std::string path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash+1);
+}
+
+// Gets the instances of a batch: all regular files of a directory (sorted by name) or the lines of a manifest file.
+// Relative paths in a manifest are relative to the directory of the manifest.
+std::vector<std::string> read_batch_instances(std::string path) {
+    std::vector<std::string> instances;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        throw(std::runtime_error("Batch input could not be opened."));
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            throw(std::runtime_error("Batch directory could not be opened."));
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string file = path + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && stat(file.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                instances.push_back(file);
+            }
+        }
+        closedir(dir);
+        std::sort(instances.begin(), instances.end());
+        return instances;
+    }
+
+    std::ifstream manifest(path);
+    std::string dir = path.find_last_of('/') == std::string::npos ? "" : path.substr(0, path.find_last_of('/')+1);
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        instances.push_back(line[0] == '/' ? line : dir + line);
+    }
+    return instances;
+}
+
+// Loads, solves and exports a single instance. The workers report their progress one at a time, each report is tagged
+// with its instance.
+void solve_batch_instance(batch_result& result, simplex_options& options, std::mutex& progress_mutex) {
+    simplex_options instance_options = options;
+    if (options.progress) {
+        std::string instance = result.instance;
+        instance_options.progress = [&options, &progress_mutex, instance](simplex_progress& p) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            std::cerr << instance << ": ";
+            options.progress(p);
+        };
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        Graph g(result.instance);
+        std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - start;
+        result.load_time = load_time.count();
+
+        start = std::chrono::steady_clock::now();
+        simplex_stats stats;
+        std::vector<flow_t> flow = network_simplex(g, instance_options, stats);
+        std::chrono::duration<double> solve_time = std::chrono::steady_clock::now() - start;
+        result.solve_time = solve_time.count();
+        result.pivots = stats.pivots;
+        result.status = stats.status;
+        if (!stats.feasible) {
+            throw(std::runtime_error(stats.status == INFEASIBLE ? "Did not find feasible solution." : solve_status_name(stats.status) + " before the flow became feasible"));
+        }
+
+        for (edge_t e = 0; e < g.edge_count; e++) {
+            result.objective += g.cost[e] * flow[e];
+        }
+
+        std::ofstream out(result.output);
+        if (!out.is_open()) {
+            throw(std::runtime_error("Output file could not be opened."));
+        }
+        g.export_min_cost_flow(flow, out);
+    } catch (std::exception& e) {
+        result.error = e.what();
+    }
+}
+
+// Solves the instances on a pool of workers, every worker holds at most one instance in memory at a time.
+// The solution of each instance is written to output_dir/<name of the instance>.out.
+std::vector<batch_result> solve_batch(std::vector<std::string>& instances, std::string output_dir, simplex_options& options, unsigned int workers) {
+    if (mkdir(output_dir.c_str(), 0777) != 0 && errno != EEXIST) {
+        throw(std::runtime_error("Output directory could not be created: " + std::string(std::strerror(errno))));
+    }
+
+    std::vector<batch_result> results(instances.size());
+    std::set<std::string> outputs;
+    for (size_t i = 0; i < instances.size(); i++) {
+        results[i].instance = instances[i];
+        std::string name = base_name(instances[i]);
+        if (!outputs.insert(name).second) {
+            name += "_" + std::to_string(i); // two instances with the same name
+            outputs.insert(name);
+        }
+        results[i].output = output_dir + "/" + name + ".out";
+    }
+
+    std::atomic<size_t> next(0);
+    std::mutex progress_mutex;
+    std::function<void(unsigned int)> job = [&](unsigned int) {
+        for (size_t i = next++; i < results.size(); i = next++) {
+            solve_batch_instance(results[i], options, progress_mutex);
+        }
+    };
+    ThreadPool pool(std::max(1u, std::min(workers, (unsigned int) std::max((size_t) 1, instances.size()))));
+    pool.run(job);
+
+    return results;
+}
+
+// Writes a table with one line per instance
+void write_batch_summary(std::vector<batch_result>& results, std::ostream& out) {
+    size_t width = 8;
+    for (batch_result& r : results) {
+        width = std::max(width, r.instance.size());
+    }
+
+    out << std::left << std::setw(width) << "instance" << std::right << std::setw(16) << "objective" << std::setw(12) << "pivots"
+        << std::setw(12) << "load [s]" << std::setw(12) << "solve [s]" << "  status" << std::endl;
+    double load_total = 0, solve_total = 0;
+    for (batch_result& r : results) {
+        out << std::left << std::setw(width) << r.instance << std::right;
+        if (r.error.empty()) {
+            out << std::setw(16) << r.objective << std::setw(12) << r.pivots << std::fixed << std::setprecision(4)
+                << std::setw(12) << r.load_time << std::setw(12) << r.solve_time << std::defaultfloat
+                << "  " << solve_status_name(r.status) << std::endl;
+        } else {
+            out << "  error: " << r.error << std::endl;
+        }
+        load_total += r.load_time;
+        solve_total += r.solve_time;
+    }
+    out << std::left << std::setw(width) << "total" << std::right << std::setw(28) << "" << std::fixed << std::setprecision(4)
+        << std::setw(12) << load_total << std::setw(12) << solve_total << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,27 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "NetworkSimplex.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Result of solving one instance of a batch
+class batch_result {
+public:
+    std::string instance;
+    std::string output;
+    std::string error; // empty if a feasible flow has been written
+    solve_status status = OPTIMAL; // the flow is feasible but not optimal if a limit has been reached
+    cost_t objective = 0;
+    unsigned long long pivots = 0;
+    double load_time = 0;
+    double solve_time = 0;
+};
+
+std::vector<std::string> read_batch_instances(std::string path);
+std::vector<batch_result> solve_batch(std::vector<std::string>& instances, std::string output_dir, simplex_options& options, unsigned int workers);
+void write_batch_summary(std::vector<batch_result>& results, std::ostream& out);
+
+#endif
@@ -0,0 +1,235 @@
+/* Implementation of the cost scaling push-relabel algorithm */
+#include "CostScaling.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+// Factor by which epsilon shrinks in each phase
+const cost_t ALPHA = 16;
+
+// Builds the arcs of the edges of g from its adjacency index and those of the artificial edges between the nodes with
+// nonzero supply and the root. At each node the arcs of the leaving edges come first, then those of the entering ones.
+ResidualGraph::ResidualGraph(Graph& g, cost_t artificial, cost_t scale) : node_count(g.node_count + 1) {
+    node_t root = g.node_count;
+    edge_t m = g.edge_count;
+    Adjacency& adjacency = g.adjacency();
+
+    // The artificial edges are numbered after the edges of g, appended edges of g (beyond edge_count) are ignored
+    std::vector<node_t> artificial_node;
+    for (node_t i=0; i<g.node_count; i++) {
+        if (g.supply[i] != 0) {
+            artificial_node.push_back(i);
+        }
+    }
+    edge_t edges = m + artificial_node.size();
+    arc_head.resize(2 * edges);
+    rev.resize(2 * edges);
+    res_cap.resize(2 * edges);
+    arc_cost.resize(2 * edges);
+    edge_arc.resize(edges);
+    std::vector<edge_t> back_arc(edges);
+    first.assign(node_count + 1, 0);
+
+    edge_t a = 0;
+    edge_t artificial_edges = 0;
+    auto add_arc = [&](node_t w, flow_t cap, cost_t cost) {
+        arc_head[a] = w;
+        res_cap[a] = cap;
+        arc_cost[a] = cost * scale;
+        return a++;
+    };
+    for (node_t v=0; v<root; v++) {
+        first[v] = a;
+        for (edge_t k = adjacency.first_out[v]; k < adjacency.first_out[v+1]; k++) {
+            edge_t e = adjacency.out_edges[k];
+            if (e < m) {
+                edge_arc[e] = add_arc(g.head[e], g.cap[e], g.cost[e]);
+            }
+        }
+        for (edge_t k = adjacency.first_in[v]; k < adjacency.first_in[v+1]; k++) {
+            edge_t e = adjacency.in_edges[k];
+            if (e < m) {
+                back_arc[e] = add_arc(g.tail[e], 0, -g.cost[e]);
+            }
+        }
+        // Supply goes from its node to the root, demand from the root to its node
+        if (g.supply[v] > 0) {
+            edge_arc[m + artificial_edges] = add_arc(root, g.supply[v], artificial);
+            artificial_edges++;
+        } else if (g.supply[v] < 0) {
+            back_arc[m + artificial_edges] = add_arc(root, 0, -artificial);
+            artificial_edges++;
+        }
+    }
+    first[root] = a;
+    for (edge_t j=0; j<artificial_edges; j++) {
+        node_t i = artificial_node[j];
+        if (g.supply[i] > 0) {
+            back_arc[m+j] = add_arc(i, 0, -artificial);
+        } else {
+            edge_arc[m+j] = add_arc(i, -g.supply[i], artificial);
+        }
+    }
+    first[node_count] = a;
+
+    for (edge_t e=0; e<edges; e++) {
+        rev[edge_arc[e]] = back_arc[e];
+        rev[back_arc[e]] = edge_arc[e];
+    }
+}
+
+// Contains all variables of the push-relabel phases
+class scaling_vars {
+public:
+    scaling_vars(ResidualGraph& r) : excess(r.node_count, 0), pot(r.node_count, 0), current(r.node_count, 0),
+        queue(r.node_count), queued(r.node_count, false) { }
+
+    std::vector<flow_t> excess;
+    std::vector<pot_t> pot;
+    std::vector<edge_t> current; // next arc to look at for an admissible one
+    std::vector<node_t> queue; // active nodes in FIFO order (ring buffer, every node is at most once in it)
+    std::vector<bool> queued;
+    node_t queue_begin = 0;
+    node_t queue_size = 0;
+};
+
+void enqueue(node_t v, scaling_vars& vars) {
+    if (!vars.queued[v]) {
+        vars.queued[v] = true;
+        vars.queue[(vars.queue_begin + vars.queue_size) % vars.queue.size()] = v;
+        vars.queue_size++;
+    }
+}
+
+node_t dequeue(scaling_vars& vars) {
+    node_t v = vars.queue[vars.queue_begin];
+    vars.queue_begin = (vars.queue_begin + 1) % vars.queue.size();
+    vars.queue_size--;
+    vars.queued[v] = false;
+    return v;
+}
+
+void push(node_t v, edge_t a, flow_t delta, ResidualGraph& r, scaling_vars& vars) {
+    r.res_cap[a] -= delta;
+    r.res_cap[r.rev[a]] += delta;
+    vars.excess[v] -= delta;
+    vars.excess[r.arc_head[a]] += delta;
+}
+
+// Lowers the potential of v as far as possible while keeping all residual arcs leaving v epsilon-optimal,
+// afterwards at least one of them is admissible
+void relabel(node_t v, cost_t epsilon, ResidualGraph& r, scaling_vars& vars) {
+    bool found = false;
+    pot_t best = 0;
+    for (edge_t a = r.first[v]; a < r.first[v+1]; a++) {
+        if (r.res_cap[a] > 0) {
+            pot_t candidate = vars.pot[r.arc_head[a]] - r.arc_cost[a];
+            if (!found || candidate > best) {
+                best = candidate;
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        throw(std::runtime_error("Node with excess has no residual arc."));
+    }
+    vars.pot[v] = best - epsilon;
+    vars.current[v] = r.first[v];
+}
+
+// Pushes the excess of v over admissible arcs (negative reduced cost) until it is gone, relabels if there is none
+void discharge(node_t v, cost_t epsilon, ResidualGraph& r, scaling_vars& vars, cost_scaling_stats& stats) {
+    while (vars.excess[v] > 0) {
+        edge_t a = vars.current[v];
+        edge_t end = r.first[v+1];
+        while (a < end && (r.res_cap[a] == 0 || r.arc_cost[a] + vars.pot[v] - vars.pot[r.arc_head[a]] >= 0)) {
+            a++;
+        }
+        if (a == end) {
+            relabel(v, epsilon, r, vars);
+            stats.relabels++;
+            continue;
+        }
+        vars.current[v] = a;
+
+        node_t w = r.arc_head[a];
+        flow_t delta = std::min(vars.excess[v], r.res_cap[a]);
+        bool was_active = vars.excess[w] > 0;
+        push(v, a, delta, r, vars);
+        stats.pushes++;
+        if (!was_active && vars.excess[w] > 0) {
+            enqueue(w, vars);
+        }
+    }
+}
+
+// Turns the epsilon*ALPHA-optimal flow into an epsilon-optimal one: saturates all arcs with negative reduced cost and
+// discharges the active nodes in FIFO order
+void refine(cost_t epsilon, ResidualGraph& r, scaling_vars& vars, cost_scaling_stats& stats) {
+    for (node_t v=0; v<r.node_count; v++) {
+        for (edge_t a = r.first[v]; a < r.first[v+1]; a++) {
+            if (r.res_cap[a] > 0 && r.arc_cost[a] + vars.pot[v] - vars.pot[r.arc_head[a]] < 0) {
+                push(v, a, r.res_cap[a], r, vars);
+            }
+        }
+        vars.current[v] = r.first[v];
+    }
+
+    for (node_t v=0; v<r.node_count; v++) {
+        if (vars.excess[v] > 0) {
+            enqueue(v, vars);
+        }
+    }
+    while (vars.queue_size > 0) {
+        discharge(dequeue(vars), epsilon, r, vars, stats);
+    }
+}
+
+std::vector<flow_t> cost_scaling(Graph& g, cost_scaling_stats& stats) {
+    supply_t total_supply = 0;
+    cost_t max_cost = 0;
+    for (node_t i=0; i<g.node_count; i++) {
+        total_supply += g.supply[i];
+    }
+    if (total_supply != 0) {
+        throw(std::runtime_error("Did not find feasible solution."));
+    }
+    for (edge_t e=0; e<g.edge_count; e++) {
+        max_cost = std::max(max_cost, std::abs(g.cost[e]));
+    }
+
+    // With the costs multiplied by the number of nodes, a 1-optimal flow is optimal
+    cost_t artificial = 1 + g.node_count * max_cost;
+    cost_t scale = g.node_count + 1;
+
+    // The potentials drop by less than 3 * nodes * epsilon per phase, so in total by less than 6 * nodes * the initial epsilon
+    long double bound = 6.0L * (g.node_count + 1) * (long double) artificial * scale;
+    if (bound > 4e18L) {
+        throw(std::runtime_error("Costs are too large for cost scaling."));
+    }
+
+    ResidualGraph r(g, artificial, scale);
+    scaling_vars vars(r);
+    for (node_t i=0; i<g.node_count; i++) {
+        vars.excess[i] = g.supply[i];
+    }
+
+    cost_t epsilon = artificial * scale;
+    do {
+        epsilon = std::max(epsilon / ALPHA, (cost_t) 1);
+        refine(epsilon, r, vars, stats);
+        stats.phases++;
+    } while (epsilon > 1);
+
+    std::vector<flow_t> flow(g.edge_count);
+    for (edge_t e=0; e<g.edge_count; e++) {
+        flow[e] = g.cap[e] - r.res_cap[r.edge_arc[e]];
+    }
+    for (edge_t e=g.edge_count; e<r.edge_arc.size(); e++) {
+        if (r.res_cap[r.rev[r.edge_arc[e]]] > 0) {
+            throw(std::runtime_error("Did not find feasible solution."));
+        }
+    }
+    return flow;
+}
@@ -0,0 +1,36 @@
+#ifndef COST_SCALING_H
+#define COST_SCALING_H
+
+#include "Graph.h"
+
+#include <vector>
+
+// Residual graph in compressed sparse row form. The arcs first[v] ... first[v+1]-1 leave v. Every edge has a
+// forward and a backward arc, rev links the two.
+class ResidualGraph {
+public:
+    ResidualGraph(Graph& g, cost_t artificial, cost_t scale);
+
+    node_t node_count; // including the artificial root g.node_count
+    std::vector<edge_t> first;
+    std::vector<node_t> arc_head;
+    std::vector<edge_t> rev;
+    std::vector<flow_t> res_cap;
+    std::vector<cost_t> arc_cost; // multiplied by scale
+    std::vector<edge_t> edge_arc; // forward arc of each edge of g, followed by those of the artificial edges
+};
+
+// Statistics of a run of the cost scaling engine
+class cost_scaling_stats {
+public:
+    unsigned long long phases = 0;
+    unsigned long long pushes = 0;
+    unsigned long long relabels = 0;
+};
+
+// Cost scaling push-relabel (Goldberg). Like the network simplex, each node with nonzero supply gets an artificial
+// edge to or from a root node whose cost is larger than that of any path of real edges, a flow on one of them at
+// the end means that the instance is infeasible.
+std::vector<flow_t> cost_scaling(Graph& g, cost_scaling_stats& stats);
+
+#endif
@@ -1,47 +1,379 @@
 #include "Graph.h"
+#include "IntegerScanner.h"
+#include "IntegerWriter.h"
 
-// Loads v graph from the file given wy filename
-Graph::Graph(std::string filename) {
-    std::fstream file(filename, std::ios_base::in);
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-    // Check if file is open
-    if (!file.is_open()) {
-        throw(std::runtime_error("File could not be opened."));
+// Header of the binary instance format. It is followed by the arrays supply, cost, cap, tail and head in native byte order.
+// cost and cap are stored with 4 bytes per value if all values fit, with 8 bytes otherwise.
+struct binary_header {
+    char magic[8];
+    uint64_t node_count;
+    uint64_t edge_count;
+    uint32_t cost_width;
+    uint32_t cap_width;
+};
+
+const char BINARY_MAGIC[8] = {'M', 'C', 'F', 'B', 'I', 'N', '1', '\0'};
+
+// Loads v graph from the file given wy filename (plain text or gzip compressed if it ends in .gz)
+template<typename value_t>
+BasicGraph<value_t>::BasicGraph(std::string filename) {
+    if (is_binary_instance(filename)) {
+        load_binary(filename);
         return;
     }
 
-    file >> node_count;
-    node_t v, w;
-    flow_t cap;
-    cost_t cost;
+    IntegerScanner file(filename);
+    long long v, w, edge_cap, edge_cost;
+
+    if (!file.next(v)) {
+        throw(std::runtime_error("Input file is empty."));
+    }
+    // The root of the network simplex gets the id node_count
+    if (v < 0 || v >= (long long) std::numeric_limits<edge_t>::max()) {
+        throw(std::runtime_error("Input file has a negative or too large node count."));
+    }
+    node_count = v;
 
-    // Reserve memory
-    supply.reserve(node_count);
     // Write supply values to supply vector
+    supply.resize(node_count);
     for (node_t i=0; i<node_count; i++) {
-        file >> supply[i];
+        if (!file.next(v)) {
+            throw(std::runtime_error("Input file ends within the supplies."));
+        }
+        supply[i] = v;
     }
 
     // read edge count
-    file >> edge_count;
+    if (file.next(v)) {
+        // The artificial edges of the network simplex are appended behind the edges, one per node
+        if (v < 0 || v >= (long long) std::numeric_limits<edge_t>::max() - node_count) {
+            throw(std::runtime_error("Input file has a negative or too large edge count."));
+        }
+        edge_count = v;
+    }
+
+    // Reserve memory, the artificial edges of the network simplex are added later
+    tail.reserve(edge_count + node_count);
+    head.reserve(edge_count + node_count);
+    cap.reserve(edge_count + node_count);
+    cost.reserve(edge_count + node_count);
 
     // add edges until no more left
-    while (file >> v >> w >> cap >> cost) {
-        edges.push_back(Edge(v, w, cap, cost));
+    while (file.next(v) && file.next(w) && file.next(edge_cap) && file.next(edge_cost)) {
+        add_edge(v, w, edge_cap, edge_cost);
+    }
+}
+
+// Appends an edge from v to w
+template<typename value_t>
+void BasicGraph<value_t>::add_edge(node_t v, node_t w, flow_t edge_cap, cost_t edge_cost) {
+    if ((value_t) edge_cap != edge_cap || (value_t) edge_cost != edge_cost) {
+        throw(std::runtime_error("Capacity or cost does not fit into the value type of the graph."));
+    }
+    tail.push_back(v);
+    head.push_back(w);
+    cap.push_back(edge_cap);
+    cost.push_back(edge_cost);
+}
+
+// Removes the last edge
+template<typename value_t>
+void BasicGraph<value_t>::pop_edge() {
+    adjacency_built = false;
+    tail.pop_back();
+    head.pop_back();
+    cap.pop_back();
+    cost.pop_back();
+}
+
+template<typename value_t>
+Adjacency& BasicGraph<value_t>::adjacency() {
+    if (!adjacency_built || adjacency_index.edges != tail.size()) {
+        build_adjacency();
+    }
+    return adjacency_index;
+}
+
+// Counting sort of the edges by tail and by head, O(n+m)
+template<typename value_t>
+void BasicGraph<value_t>::build_adjacency() {
+    Adjacency& a = adjacency_index;
+    edge_t edges = tail.size();
+    node_t slots = node_count + 1;
+    a.edges = edges;
+    a.first_out.assign(slots + 1, 0);
+    a.first_in.assign(slots + 1, 0);
+    for (edge_t e=0; e<edges; e++) {
+        a.first_out[tail[e]+1]++;
+        a.first_in[head[e]+1]++;
+    }
+    for (node_t v=0; v<slots; v++) {
+        a.first_out[v+1] += a.first_out[v];
+        a.first_in[v+1] += a.first_in[v];
     }
+    a.out_edges.resize(edges);
+    a.in_edges.resize(edges);
+    std::vector<edge_t> next_out(a.first_out.begin(), a.first_out.end()-1);
+    std::vector<edge_t> next_in(a.first_in.begin(), a.first_in.end()-1);
+    for (edge_t e=0; e<edges; e++) {
+        a.out_edges[next_out[tail[e]]++] = e;
+        a.in_edges[next_in[head[e]]++] = e;
+    }
+    adjacency_built = true;
 }
 
-void Graph::export_min_cost_flow(std::vector<flow_t>& flow, std::ostream& out) {
+// Writes the cost of the flow and a line "edge flow" for every edge with flow. If pot is given, a line -1 follows (no
+// edge has that id) and then the potential of each node on its own line, in the order of the nodes.
+template<typename value_t>
+void BasicGraph<value_t>::export_min_cost_flow(std::vector<flow_t>& flow, std::ostream& out, std::vector<pot_t>* pot) {
     cost_t value = 0;
     for (edge_t i=0; i<edge_count; i++) {
-      value += edges[i].cost * flow[i];
+      value += (cost_t) cost[i] * flow[i];
     }
 
-    out << value << std::endl;
+    IntegerWriter writer(out);
+    writer.put(value);
+    writer.put('\n');
 
     for (edge_t i=0; i<edge_count; i++) {
         if (flow[i] > 0) {
-            out << i << " " << flow[i] << std::endl;
+            writer.put((long long) i);
+            writer.put(' ');
+            writer.put(flow[i]);
+            writer.put('\n');
+        }
+    }
+
+    if (pot != nullptr) {
+        writer.put(-1LL);
+        writer.put('\n');
+        for (node_t i=0; i<node_count; i++) {
+            writer.put((*pot)[i]);
+            writer.put('\n');
+        }
+    }
+    writer.flush();
+}
+
+// Checks whether the file starts with the magic number of the binary format
+template<typename value_t>
+bool BasicGraph<value_t>::is_binary_instance(std::string filename) {
+    std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+    char magic[sizeof(BINARY_MAGIC)];
+    if (!file.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+// Copies a column of the binary file into v, widening 4 byte values if necessary. A column behind a column of 4 byte
+// values need not be aligned for its type, so the values are copied bytewise.
+template<typename T>
+const char* read_column(const char* data, size_t count, uint32_t width, std::vector<T>& v) {
+    if (width == sizeof(T)) {
+        v.resize(count);
+        memcpy(v.data(), data, count * sizeof(T));
+    } else if (width == sizeof(int32_t)) {
+        v.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            int32_t value;
+            memcpy(&value, data + i * sizeof(int32_t), sizeof(int32_t));
+            v[i] = value;
+        }
+    } else {
+        throw(std::runtime_error("Unsupported value width in binary file."));
+    }
+    return data + count * width;
+}
+
+// Loads the graph from a binary file written by write_binary. The file is mapped and each array is filled by one bulk copy.
+// This is not a zero-copy load: the graph owns its arrays because the simplex appends its artificial edges to them.
+template<typename value_t>
+void BasicGraph<value_t>::load_binary(std::string filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw(std::runtime_error("File could not be opened."));
+    }
+    size_t size = st.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw(std::runtime_error("File could not be mapped."));
+    }
+
+    const char* data = (const char*) mapping;
+    binary_header header;
+    if (size < sizeof(header)) {
+        munmap(mapping, size);
+        throw(std::runtime_error("Binary file has the wrong size."));
+    }
+    memcpy(&header, data, sizeof(header));
+    if ((header.cost_width != 4 && header.cost_width != 8) || (header.cap_width != 4 && header.cap_width != 8)) {
+        munmap(mapping, size);
+        throw(std::runtime_error("Unsupported value width in binary file."));
+    }
+    // The counts come from the file, so they are compared with what is left of it by division instead of multiplying them
+    size_t rest = size - sizeof(header);
+    size_t edge_bytes = header.cost_width + header.cap_width + 2 * sizeof(node_t);
+    bool size_matches = header.node_count <= rest / sizeof(supply_t);
+    if (size_matches) {
+        rest -= header.node_count * sizeof(supply_t);
+        size_matches = header.edge_count == rest / edge_bytes && rest % edge_bytes == 0;
+    }
+    if (!size_matches) {
+        munmap(mapping, size);
+        throw(std::runtime_error("Binary file has the wrong size."));
+    }
+    // The artificial edges of the network simplex are appended behind the edges, one per node
+    if (header.node_count + header.edge_count >= std::numeric_limits<edge_t>::max()) {
+        munmap(mapping, size);
+        throw(std::runtime_error("Binary file has too many nodes or edges."));
+    }
+
+    node_count = header.node_count;
+    edge_count = header.edge_count;
+    tail.reserve(edge_count + node_count);
+    head.reserve(edge_count + node_count);
+    cap.reserve(edge_count + node_count);
+    cost.reserve(edge_count + node_count);
+
+    // 8 byte values still do not fit into the columns of a graph with 4 byte values, so the mapping is released on errors
+    try {
+        data += sizeof(header);
+        data = read_column(data, node_count, sizeof(supply_t), supply);
+        data = read_column(data, edge_count, header.cost_width, cost);
+        data = read_column(data, edge_count, header.cap_width, cap);
+        data = read_column(data, edge_count, sizeof(node_t), tail);
+        data = read_column(data, edge_count, sizeof(node_t), head);
+    } catch (...) {
+        munmap(mapping, size);
+        throw;
+    }
+
+    munmap(mapping, size);
+}
+
+// Writes a column to the binary file with the given width per value
+template<typename T>
+void write_column(std::ofstream& file, std::vector<T>& v, size_t count, uint32_t width) {
+    if (width == sizeof(T)) {
+        file.write((const char*) v.data(), count * sizeof(T));
+    } else {
+        std::vector<int32_t> values(v.begin(), v.begin() + count);
+        file.write((const char*) values.data(), count * sizeof(int32_t));
+    }
+}
+
+// Checks whether all values of a column fit into 4 bytes
+template<typename T>
+uint32_t column_width(std::vector<T>& v, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (v[i] < INT32_MIN || v[i] > INT32_MAX) {
+            return sizeof(T);
+        }
+    }
+    return sizeof(int32_t);
+}
+
+// Writes the graph to a binary file that can be loaded without parsing
+template<typename value_t>
+void BasicGraph<value_t>::write_binary(std::string filename) {
+    if (tail.size() < edge_count || head.size() < edge_count || cap.size() < edge_count || cost.size() < edge_count
+            || supply.size() < node_count) {
+        throw(std::runtime_error("Graph has fewer edges or nodes than it counts."));
+    }
+    std::ofstream file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!file.is_open()) {
+        throw(std::runtime_error("Output file could not be opened."));
+    }
+
+    binary_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.node_count = node_count;
+    header.edge_count = edge_count;
+    header.cost_width = column_width(cost, edge_count);
+    header.cap_width = column_width(cap, edge_count);
+
+    file.write((const char*) &header, sizeof(header));
+    write_column(file, supply, node_count, sizeof(supply_t));
+    write_column(file, cost, edge_count, header.cost_width);
+    write_column(file, cap, edge_count, header.cap_width);
+    write_column(file, tail, edge_count, sizeof(node_t));
+    write_column(file, head, edge_count, sizeof(node_t));
+
+    if (!file) {
+        throw(std::runtime_error("Could not write binary file."));
+    }
+}
+
+template class BasicGraph<long long>;
+template class BasicGraph<int>;
+
+bool fits_compact(Graph& g) {
+    const long long limit = std::numeric_limits<int>::max();
+    long long max_cost = 0, total_supply = 0;
+    for (edge_t e=0; e<g.edge_count; e++) {
+        if (g.cap[e] < 0 || g.cap[e] > limit || g.cost[e] < -limit || g.cost[e] > limit) {
+            return false;
+        }
+        max_cost = std::max(max_cost, std::abs(g.cost[e]));
+    }
+    // An artificial edge gets capacity excess + 1 where the excess of a subtree is at most the total supply, and cost
+    // 1 + node_count * max_cost
+    for (node_t i=0; i<g.node_count; i++) {
+        total_supply += std::abs(g.supply[i]);
+        if (total_supply > limit - 1) {
+            return false;
         }
     }
-}
\ No newline at end of file
+    return max_cost <= (limit - 1) / std::max(g.node_count, 1u);
+}
+
+// Narrows a column and releases the wide one, the capacity for the artificial edges is kept
+template<typename T, typename U>
+void move_column(std::vector<T>& from, std::vector<U>& to, size_t count, size_t reserved) {
+    to.reserve(reserved);
+    to.assign(from.begin(), from.begin() + count);
+    std::vector<T>().swap(from);
+}
+
+CompactGraph make_compact(Graph& g) {
+    CompactGraph compact(0);
+    compact.node_count = g.node_count;
+    compact.edge_count = g.edge_count;
+    // The artificial edges of an earlier solve are not taken over
+    g.tail.resize(g.edge_count);
+    g.head.resize(g.edge_count);
+    compact.supply.swap(g.supply);
+    compact.tail.swap(g.tail);
+    compact.head.swap(g.head);
+    move_column(g.cap, compact.cap, g.edge_count, g.edge_count + g.node_count);
+    move_column(g.cost, compact.cost, g.edge_count, g.edge_count + g.node_count);
+    return compact;
+}
+
+void restore_wide(CompactGraph& compact, Graph& g) {
+    compact.tail.resize(compact.edge_count);
+    compact.head.resize(compact.edge_count);
+    g.supply.swap(compact.supply);
+    g.tail.swap(compact.tail);
+    g.head.swap(compact.head);
+    move_column(compact.cap, g.cap, compact.edge_count, compact.edge_count + compact.node_count);
+    move_column(compact.cost, g.cost, compact.edge_count, compact.edge_count + compact.node_count);
+}
@@ -15,23 +15,57 @@ typedef long long int supply_t;
 typedef long long int cost_t;
 typedef long long int pot_t;
 
-class Graph {
+// Compressed sparse row index of the edges of a graph. The edges leaving v are out_edges[first_out[v]] ...
+// out_edges[first_out[v+1]-1] in increasing order of their ids, the edges entering v are stored the same way in
+// first_in and in_edges. There is a slot for the root node_count, so the artificial edges of the network simplex fit in.
+class Adjacency {
 public:
-    class Edge {
-    public:
-        Edge(node_t v, node_t w, flow_t cap, cost_t cost) : v(v), w(w), cap(cap), cost(cost) { };
-        node_t v, w;
-        flow_t cap;
-        cost_t cost;
-    };
+    std::vector<edge_t> first_out, out_edges;
+    std::vector<edge_t> first_in, in_edges;
+    edge_t edges = 0; // number of stored edges the index has been built for
+};
 
-    Graph(std::string filename);
-    void export_min_cost_flow(std::vector<flow_t>& flow, std::ostream& out);
+// Edges are stored as a structure of arrays, edge e goes from tail[e] to head[e].
+// Capacities and costs are stored as value_t, all computations with them are done in flow_t and cost_t.
+template<typename value_t>
+class BasicGraph {
+public:
+    BasicGraph(std::string filename);
+    BasicGraph(node_t node_count) : node_count(node_count), supply(node_count, 0) { };
+    void add_edge(node_t v, node_t w, flow_t edge_cap, cost_t edge_cost);
+    void pop_edge();
+    void export_min_cost_flow(std::vector<flow_t>& flow, std::ostream& out, std::vector<pot_t>* pot = nullptr);
+    void write_binary(std::string filename);
+    // Gets the adjacency index of all stored edges (including appended ones beyond edge_count). It is built on first use
+    // and again after edges have been added or removed, changes made directly to tail and head are not noticed.
+    Adjacency& adjacency();
 
     node_t node_count = 0;
     edge_t edge_count = 0;
-    std::vector<Edge> edges;
+    std::vector<node_t> tail, head;
+    std::vector<value_t> cap;
+    std::vector<value_t> cost;
     std::vector<supply_t> supply;
+
+private:
+    static bool is_binary_instance(std::string filename);
+    void load_binary(std::string filename);
+    void build_adjacency();
+
+    Adjacency adjacency_index;
+    bool adjacency_built = false;
 };
 
+typedef BasicGraph<long long> Graph;
+typedef BasicGraph<int> CompactGraph; // halves the memory traffic of the pricing
+
+// Checks whether the capacities and costs of g, including those of the artificial edges of the network simplex, fit
+// into a CompactGraph
+bool fits_compact(Graph& g);
+// Moves the edges of g into a graph with 32-bit capacities and costs, fits_compact(g) has to hold. Each wide column is
+// released once it has been narrowed, so the edges are not stored twice. g is left without edges until restore_wide.
+CompactGraph make_compact(Graph& g);
+// Moves the edges back into the graph make_compact has taken them from
+void restore_wide(CompactGraph& compact, Graph& g);
+
 #endif
\ No newline at end of file
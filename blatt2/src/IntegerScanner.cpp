@@ -0,0 +1,141 @@
+#include "IntegerScanner.h"
+
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t GZ_CHUNK_SIZE = 1 << 20;
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Opens the file given by filename
+IntegerScanner::IntegerScanner(std::string filename) {
+    if (filename.size() > 3 && filename.compare(filename.size()-3, 3, ".gz") == 0) {
+        gz = gzopen(filename.c_str(), "rb");
+        if (gz == nullptr) {
+            throw(std::runtime_error("File could not be opened."));
+        }
+        gzbuffer(gz, GZ_CHUNK_SIZE);
+        buffer.resize(GZ_CHUNK_SIZE);
+        pos = end = buffer.data();
+        eof = false;
+        return;
+    }
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw(std::runtime_error("File could not be opened."));
+    }
+
+    mapping_size = st.st_size;
+    if (mapping_size > 0) {
+        mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            close(fd);
+            throw(std::runtime_error("File could not be mapped."));
+        }
+        madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+        pos = (const char*) mapping;
+        end = pos + mapping_size;
+    }
+    close(fd);
+}
+
+IntegerScanner::~IntegerScanner() {
+    if (mapping != nullptr) {
+        munmap(mapping, mapping_size);
+    }
+    if (gz != nullptr) {
+        gzclose(gz);
+    }
+}
+
+// Moves the unread rest of the buffer to its front and fills it up from the gzip stream
+bool IntegerScanner::refill() {
+    if (eof) {
+        return false;
+    }
+
+    size_t offset = pos - buffer.data();
+    size_t rest = end - pos;
+    if (rest == buffer.size()) {
+        buffer.resize(2 * buffer.size()); // a single token fills the whole buffer
+    }
+    memmove(buffer.data(), buffer.data() + offset, rest);
+
+    int read = gzread(gz, buffer.data() + rest, buffer.size() - rest);
+    if (read < 0) {
+        throw(std::runtime_error("Could not decompress file."));
+    }
+    if (read == 0) {
+        eof = true;
+    }
+
+    pos = buffer.data();
+    end = pos + rest + read;
+    return read > 0 || rest > 0;
+}
+
+// Reads the next integer, returns false at the end of the input
+bool IntegerScanner::next(long long& value) {
+    while (true) {
+        while (pos < end && is_space(*pos)) {
+            pos++;
+        }
+        if (pos == end) {
+            if (!refill()) {
+                return false;
+            }
+            continue;
+        }
+
+        // Make sure the token is not cut off at the end of the buffer
+        const char* token_end = pos;
+        while (token_end < end && !is_space(*token_end)) {
+            token_end++;
+        }
+        if (token_end == end && !eof) {
+            refill();
+            continue;
+        }
+
+        const char* p = pos;
+        bool negative = false;
+        if (*p == '-' || *p == '+') {
+            negative = *p == '-';
+            p++;
+        }
+        if (p == token_end) {
+            throw(std::runtime_error("Invalid number in input file."));
+        }
+
+        // A negative number may be one larger in absolute value than a positive one
+        const unsigned long long max_abs = negative ? (unsigned long long) LLONG_MAX + 1 : LLONG_MAX;
+        unsigned long long abs_value = 0;
+        for (; p < token_end; p++) {
+            if (*p < '0' || *p > '9') {
+                throw(std::runtime_error("Invalid number in input file."));
+            }
+            unsigned int digit = *p - '0';
+            if (abs_value > (max_abs - digit) / 10) {
+                throw(std::runtime_error("Invalid number in input file."));
+            }
+            abs_value = 10 * abs_value + digit;
+        }
+
+        value = negative ? -(long long) (abs_value - 1) - 1 : (long long) abs_value;
+        pos = token_end;
+        return true;
+    }
+}
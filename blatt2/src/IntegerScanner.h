@@ -0,0 +1,34 @@
+#ifndef INTEGER_SCANNER_H
+#define INTEGER_SCANNER_H
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Reads whitespace separated integers from an instance file.
+// Plain files are memory-mapped, files ending in .gz are decompressed in chunks while reading.
+class IntegerScanner {
+public:
+    IntegerScanner(std::string filename);
+    ~IntegerScanner();
+    bool next(long long& value);
+
+private:
+    IntegerScanner(const IntegerScanner&);
+    IntegerScanner& operator=(const IntegerScanner&);
+    bool refill();
+
+    const char* pos = nullptr;
+    const char* end = nullptr;
+    bool eof = true;
+
+    // memory-mapped file
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    // gzip stream
+    gzFile gz = nullptr;
+    std::vector<char> buffer;
+};
+
+#endif
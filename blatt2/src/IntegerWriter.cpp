@@ -0,0 +1,54 @@
+#include "IntegerWriter.h"
+
+#include <stdexcept>
+
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+const size_t MAX_DIGITS = 20; // sign and digits of a long long
+
+IntegerWriter::IntegerWriter(std::ostream& out) : out(out), buffer(WRITE_BUFFER_SIZE) { }
+
+// Writes what is left in the buffer, errors have to be caught by calling flush before
+IntegerWriter::~IntegerWriter() {
+    if (used > 0) {
+        out.write(buffer.data(), used);
+    }
+}
+
+void IntegerWriter::put(long long value) {
+    if (used + MAX_DIGITS > buffer.size()) {
+        flush();
+    }
+
+    // Digits are produced from the back, the magnitude is unsigned so that the smallest long long works as well
+    char digits[MAX_DIGITS];
+    size_t count = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long) value : (unsigned long long) value;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        buffer[used++] = '-';
+    }
+    while (count > 0) {
+        buffer[used++] = digits[--count];
+    }
+}
+
+void IntegerWriter::put(char c) {
+    if (used == buffer.size()) {
+        flush();
+    }
+    buffer[used++] = c;
+}
+
+// Writes the buffered characters to the stream
+void IntegerWriter::flush() {
+    if (used > 0) {
+        out.write(buffer.data(), used);
+        used = 0;
+    }
+    if (!out) {
+        throw(std::runtime_error("Could not write output."));
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef INTEGER_WRITER_H
+#define INTEGER_WRITER_H
+
+#include <iostream>
+#include <vector>
+
+// Writes integers to a stream through a large buffer, the digits are formatted by hand instead of by the stream
+class IntegerWriter {
+public:
+    IntegerWriter(std::ostream& out);
+    ~IntegerWriter();
+    void put(long long value);
+    void put(char c);
+    void flush();
+
+private:
+    IntegerWriter(const IntegerWriter&);
+    IntegerWriter& operator=(const IntegerWriter&);
+
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
+
+#endif
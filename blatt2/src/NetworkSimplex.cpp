@@ -1,85 +1,446 @@
 /* Implementation of the network simplex algorithm */
 #include "NetworkSimplex.h"
 
-typedef Graph::Edge Edge;
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
 
-void recursive_potential_and_distance_update(node_t node, std::vector<bool>& updated, Graph& g, simplex_vars& vars) {
-    if (!updated[node]) {
-        ResidualEdge prev_edge_resid = ResidualEdge(g, vars.prev[node], node, false);
-        node_t previous_node = prev_edge_resid.v;
-        recursive_potential_and_distance_update(previous_node, updated, g, vars);
-        vars.dist[node] = vars.dist[previous_node] + 1;
-        vars.pot[node] = vars.pot[previous_node] + prev_edge_resid.residual_cost();
-        updated[node] = true;
+// Gets the cost of the artificial edges, it exceeds the cost of every path of real edges
+template<typename value_t>
+cost_t artificial_cost(BasicGraph<value_t>& g, cost_t max_cost) {
+    return 1 + g.node_count * max_cost;
+}
+
+template<typename value_t>
+void make_strongly_feasible_instance(BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    // Find max absolute edge cost
+    vars.max_cost = 0;
+    for (edge_t e = 0; e < g.edge_count; e++) {
+        vars.max_cost = std::max(vars.max_cost, std::abs((cost_t) g.cost[e]));
     }
+    cost_t big_m = artificial_cost(g, vars.max_cost);
+
+    for (node_t i=0; i<g.node_count; i++) {
+        // node i is a sink
+        if (g.supply[i] < 0) {
+            g.add_edge(g.node_count, i, -g.supply[i], big_m);
+            vars.flow[g.edge_count+i] = -g.supply[i];
+
+        } else { // node i is not
+            g.add_edge(i, g.node_count, g.supply[i]+1, big_m);
+            vars.flow[g.edge_count+i] = g.supply[i];
+        }
+        vars.tree.prev[i] = g.edge_count+i;
+        vars.state[g.edge_count+i] = STATE_TREE;
+    }
+
+    // Every node hangs directly below the root
+    vars.tree.build(g);
+    vars.tree.compute_potentials(g, vars.pot);
 }
 
-void update_potential_and_distance(Graph& g, simplex_vars& vars) {
-    std::vector<bool> updated(g.node_count+1, false);
-    updated[g.node_count] = true;
+// Throws if x cannot be stored as a capacity or cost of the graph
+template<typename value_t>
+void check_value(long long x) {
+    if ((value_t) x != x) {
+        throw(std::overflow_error("Value does not fit into the capacities and costs of the graph."));
+    }
+}
 
-    for (node_t i = 0; i < g.node_count; i++) {
-        recursive_potential_and_distance_update(i, updated, g, vars);
+// Turns the artificial edge of node x into its tree edge, oriented such that it carries the excess of the subtree of x
+template<typename value_t>
+void hang_below_root(node_t x, flow_t excess, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    edge_t a = g.edge_count + x;
+    check_value<value_t>(excess >= 0 ? excess + 1 : -excess);
+    if (excess >= 0) {
+        g.tail[a] = x;
+        g.head[a] = g.node_count;
+        g.cap[a] = excess + 1;
+        vars.flow[a] = excess;
+    } else {
+        g.tail[a] = g.node_count;
+        g.head[a] = x;
+        g.cap[a] = -excess;
+        vars.flow[a] = -excess;
     }
+    vars.tree.prev[x] = a;
+    vars.state[a] = STATE_TREE;
 }
 
-void make_strongly_feasible_instance(Graph& g, simplex_vars& vars) {
-    // Find max edge cost
-    cost_t max_cost = abs(g.edges[0].cost);
-    for (edge_t e = 0; e < g.edge_count; e++) {
-        if (g.edges[e].cost > max_cost) {
-            max_cost = abs(g.edges[e].cost);
+// Makes the last tree primal feasible again after supplies or capacities have changed.
+// Non-tree edges are put on their bounds, then the tree flows are recomputed bottom-up. A tree edge that cannot carry
+// its new flow (or would no longer allow to push flow towards the root) is put on a bound and its subtree is hung below
+// the root through its artificial edge, so the result is a strongly feasible tree again.
+template<typename value_t>
+void repair_basis(BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    node_t root = g.node_count;
+    edge_t m = g.edge_count;
+    std::vector<flow_t> excess(root+1, 0);
+    for (node_t x = 0; x < root; x++) {
+        excess[x] = g.supply[x];
+    }
+
+    for (edge_t e = 0; e < m + root; e++) {
+        if (vars.state[e] == STATE_TREE) {
+            continue;
+        }
+        if (e >= m) {
+            vars.state[e] = STATE_LOWER;
+        }
+        vars.flow[e] = vars.state[e] == STATE_UPPER ? g.cap[e] : 0;
+        excess[g.tail[e]] -= vars.flow[e];
+        excess[g.head[e]] += vars.flow[e];
+    }
+
+    // Children come before their parents in the reversed preorder
+    for (node_t x = vars.tree.rev_thread[root]; x != root; x = vars.tree.rev_thread[x]) {
+        node_t p = vars.tree.parent[x];
+        edge_t e = vars.tree.prev[x];
+        if (e >= m) {
+            hang_below_root(x, excess[x], g, vars);
+            continue;
+        }
+
+        bool up = g.tail[e] == x; // e points towards the root
+        flow_t f = up ? excess[x] : -excess[x];
+        if (f >= 0 && f <= g.cap[e] && (up ? g.cap[e] - f : f) > 0) {
+            vars.flow[e] = f;
+            excess[p] += excess[x];
+            continue;
         }
+
+        f = std::min(std::max(f, (flow_t) 0), (flow_t) g.cap[e]);
+        vars.flow[e] = f;
+        vars.state[e] = f == 0 ? STATE_LOWER : STATE_UPPER;
+        excess[x] += up ? -f : f;
+        excess[p] += up ? f : -f;
+        hang_below_root(x, excess[x], g, vars);
     }
 
+    vars.tree.build(g);
+}
 
-    // Add all edges from the graph to L
-    for (edge_t i=0; i<g.edge_count; i++) {
-        vars.L.push_back(i);
+pricing_strategy parse_pricing_strategy(std::string name) {
+    if (name == "first") {
+        return FIRST_ELIGIBLE;
+    } else if (name == "block") {
+        return BLOCK_SEARCH;
+    } else if (name == "candidate") {
+        return CANDIDATE_LIST;
+    } else if (name == "dantzig") {
+        return DANTZIG;
     }
+    throw(std::invalid_argument("Unknown pricing strategy " + name));
+}
 
-    for (node_t i=0; i<g.node_count; i++) {
-        // node i is a sink
-        if (g.supply[i] < 0) {
-            g.edges.push_back(Edge(g.node_count, i, -g.supply[i], 1+g.node_count*max_cost));
-            vars.flow[g.edge_count+i] = -g.supply[i];
+// Replaces artificial tree edges by real ones before the first pivot. A shortest path tree (Dijkstra with negative costs
+// rounded up to 0) backwards from the demand nodes attaches every node it reaches through the first edge of its path,
+// so supply can flow to the demands on cheap real paths from the start and most potentials come from real costs instead
+// of the big-M. repair_basis then computes the tree flows and hangs every subtree whose edge cannot carry its supply
+// below the root again.
+template<typename value_t>
+void crash_basis(BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    node_t root = g.node_count;
+    edge_t m = g.edge_count;
 
-        } else { // node i is not
-            g.edges.push_back(Edge(i, g.node_count, g.supply[i]+1, 1+g.node_count*max_cost));
-            vars.flow[g.edge_count+i] = g.supply[i];
+    Adjacency& adjacency = g.adjacency();
+
+    typedef std::pair<cost_t, node_t> heap_entry;
+    std::vector<cost_t> dist(root, std::numeric_limits<cost_t>::max());
+    std::vector<bool> done(root, false);
+    std::priority_queue<heap_entry, std::vector<heap_entry>, std::greater<heap_entry>> heap;
+    for (node_t v = 0; v < root; v++) {
+        if (g.supply[v] < 0) {
+            dist[v] = 0;
+            heap.push(std::make_pair(0, v));
+        }
+    }
+    while (!heap.empty()) {
+        node_t u = heap.top().second;
+        heap.pop();
+        if (done[u]) {
+            continue;
+        }
+        done[u] = true;
+        for (edge_t k = adjacency.first_in[u]; k < adjacency.first_in[u+1]; k++) {
+            edge_t e = adjacency.in_edges[k];
+            if (e >= m || g.cap[e] <= 0) {
+                continue; // artificial edge or no capacity
+            }
+            node_t v = g.tail[e];
+            cost_t d = dist[u] + std::max((cost_t) g.cost[e], (cost_t) 0);
+            if (!done[v] && d < dist[v]) {
+                dist[v] = d;
+                heap.push(std::make_pair(d, v));
+                vars.state[vars.tree.prev[v]] = STATE_LOWER;
+                vars.tree.prev[v] = e;
+                vars.state[e] = STATE_TREE;
+            }
         }
-        vars.prev[i] = g.edge_count+i;
     }
-    update_potential_and_distance(g, vars);
+
+    vars.tree.build(g);
+    repair_basis(g, vars);
+    vars.tree.compute_potentials(g, vars.pot);
 }
 
-// Finds a new edge to be added to the basis and returns whether a better edge has been found in L or U
-bool find_new_edge(ResidualEdge& new_edge, Graph& g, simplex_vars& vars) {
-    // look for better basis edge in L
-    for (auto i = vars.L.begin(); i != vars.L.end(); i++) {
-        ResidualEdge res_e = ResidualEdge(g, *i, true);
-        if (res_e.potential_cost(vars.pot) < 0) {
-            new_edge = res_e;
-            vars.L.erase(i); // Edge will be added to basis
-            return true;
+// Gets the reduced cost of edge e in the direction in which it could enter the basis, 0 for tree edges
+template<typename value_t>
+inline cost_t pricing_cost(edge_t e, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    return vars.state[e] * (g.cost[e] + vars.pot[g.tail[e]] - vars.pot[g.head[e]]);
+}
+
+std::string solve_status_name(solve_status status) {
+    switch (status) {
+    case OPTIMAL:
+        return "optimal";
+    case INFEASIBLE:
+        return "infeasible";
+    case TIME_LIMIT:
+        return "time limit reached";
+    case PIVOT_LIMIT:
+        return "pivot limit reached";
+    }
+    return "unknown";
+}
+
+// Gets the cost of the flow on the real edges and the flow that is left on the artificial edges
+template<typename value_t>
+void get_progress(simplex_progress& progress, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    progress.objective = 0;
+    for (edge_t e=0; e<g.edge_count; e++) {
+        progress.objective += (cost_t) g.cost[e] * vars.flow[e];
+    }
+    progress.artificial_edges = 0;
+    progress.artificial_flow = 0;
+    for (node_t i=0; i<g.node_count; i++) {
+        if (vars.flow[g.edge_count+i] > 0) {
+            progress.artificial_edges++;
+            progress.artificial_flow += vars.flow[g.edge_count+i];
         }
     }
+}
 
-    // look for better basis edge in U
-    for (auto i = vars.U.begin(); i != vars.U.end(); i++) {
-        ResidualEdge res_e = ResidualEdge(g, *i, false);
-        if (res_e.potential_cost(vars.pot) < 0) {
-            new_edge = res_e;
-            vars.U.erase(i); // Edge will be added to basis
+// Sets up the parameters of the pricing rule (block and list sizes as in LEMON)
+template<typename value_t>
+void init_pricing(BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    unsigned int sqrt_m = (unsigned int) sqrt((double) g.edge_count);
+    vars.block_size = std::max(10u, sqrt_m);
+    vars.list_length = std::max(10u, sqrt_m / 4);
+    vars.minor_limit = std::max(3u, vars.list_length / 10);
+    vars.minor_count = 0;
+    vars.candidates.clear();
+    vars.next_edge = 0;
+}
+
+// Takes the eligible edge with the smallest id
+template<typename value_t>
+bool find_first_eligible_edge(edge_t& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    edge_t m = vars.state.size();
+    for (edge_t e = 0; e < m; e++) {
+        if (pricing_cost(e, g, vars) < 0) {
+            new_edge = e;
             return true;
         }
     }
-
     return false;
 }
 
+// Runs the pricing kernel on the edges [from, to)
+template<typename value_t>
+inline cost_t price_range(edge_t from, edge_t to, edge_t& best_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    return vars.kernel(vars.state.data(), g.cost.data(), g.tail.data(), g.head.data(), vars.pot.data(), from, to, best_edge);
+}
+
+// Scans the edges blockwise starting at next_edge and takes the best edge of the first block that contains an eligible edge
+template<typename value_t>
+bool find_block_search_edge(edge_t& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    edge_t m = vars.state.size();
+    edge_t e = vars.next_edge;
+    cost_t best_cost = 0;
+    edge_t in_block = 0;
+    for (edge_t scanned = 0; scanned < m; ) {
+        // a block that wraps around is priced in two pieces
+        edge_t length = std::min(std::min(vars.block_size - in_block, m - scanned), m - e);
+        edge_t candidate;
+        cost_t c = price_range(e, e + length, candidate, g, vars);
+        if (c < best_cost) {
+            best_cost = c;
+            new_edge = candidate;
+        }
+        scanned += length;
+        e += length;
+        if (e == m) {
+            e = 0;
+        }
+
+        in_block += length;
+        if (in_block == vars.block_size) {
+            if (best_cost < 0) {
+                break;
+            }
+            in_block = 0;
+        }
+    }
+    vars.next_edge = e;
+
+    return best_cost < 0;
+}
+
+// Partial pricing: picks the best edge of the candidate list and rebuilds the list after minor_limit pivots or once it runs empty
+template<typename value_t>
+bool find_candidate_list_edge(edge_t& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    cost_t best_cost = 0;
+
+    // minor iteration, drops candidates that are no longer eligible (including the edge that entered last)
+    if (!vars.candidates.empty() && vars.minor_count < vars.minor_limit) {
+        vars.minor_count++;
+        size_t kept = 0;
+        for (size_t i = 0; i < vars.candidates.size(); i++) {
+            edge_t e = vars.candidates[i];
+            cost_t c = pricing_cost(e, g, vars);
+            if (c < 0) {
+                if (c < best_cost) {
+                    best_cost = c;
+                    new_edge = e;
+                }
+                vars.candidates[kept++] = e;
+            }
+        }
+        vars.candidates.resize(kept);
+    }
+
+    // major iteration
+    if (best_cost >= 0) {
+        vars.minor_count = 0;
+        vars.candidates.clear();
+        edge_t m = vars.state.size();
+        edge_t e = vars.next_edge;
+        for (edge_t i = 0; i < m && vars.candidates.size() < vars.list_length; i++) {
+            cost_t c = pricing_cost(e, g, vars);
+            if (c < 0) {
+                vars.candidates.push_back(e);
+                if (c < best_cost) {
+                    best_cost = c;
+                    new_edge = e;
+                }
+            }
+            if (++e == m) {
+                e = 0;
+            }
+        }
+        vars.next_edge = e;
+    }
+
+    return best_cost < 0;
+}
+
+// Takes the edge with the most negative reduced cost
+template<typename value_t>
+bool find_dantzig_edge(edge_t& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    return price_range(0, vars.state.size(), new_edge, g, vars) < 0;
+}
+
+// Edges that each thread scans at least per round of parallel pricing, smaller rounds do not pay for the synchronization
+const edge_t PARALLEL_MIN_CHUNK = 4096;
+
+// Scans the share of thread t of the current round and stores its best edge in results[t]
+template<typename value_t>
+void scan_pricing_round(unsigned int t, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    unsigned long long threads = vars.pool->size();
+    unsigned long long m = vars.state.size();
+    unsigned long long from = vars.round_start + t * (unsigned long long) vars.round_length / threads;
+    unsigned long long to = vars.round_start + (t+1) * (unsigned long long) vars.round_length / threads;
+
+    // the share may wrap around
+    edge_t best_edge = 0;
+    cost_t best_cost = price_range(std::min(from, m), std::min(to, m), best_edge, g, vars);
+    if (to > m) {
+        edge_t wrapped_edge;
+        cost_t c = price_range(std::max(from, m) - m, to - m, wrapped_edge, g, vars);
+        if (c < best_cost) {
+            best_cost = c;
+            best_edge = wrapped_edge;
+        }
+    }
+    vars.results[t].cost = best_cost;
+    vars.results[t].edge = best_edge;
+}
+
+// Runs one round of parallel pricing and reduces the results of the threads, ties go to the lower thread index
+template<typename value_t>
+cost_t run_pricing_round(edge_t& new_edge, simplex_vars<value_t>& vars) {
+    vars.pool->run(vars.pricing_job);
+
+    cost_t best_cost = 0;
+    for (unsigned int t = 0; t < vars.pool->size(); t++) {
+        if (vars.results[t].cost < best_cost) {
+            best_cost = vars.results[t].cost;
+            new_edge = vars.results[t].edge;
+        }
+    }
+    return best_cost;
+}
+
+// Block search where every thread scans its own block per round
+template<typename value_t>
+bool find_parallel_block_search_edge(edge_t& new_edge, simplex_vars<value_t>& vars) {
+    edge_t m = vars.state.size();
+    edge_t chunk = std::max((edge_t) vars.block_size, PARALLEL_MIN_CHUNK) * vars.pool->size();
+    edge_t scanned = 0;
+    cost_t best_cost = 0;
+    while (scanned < m && best_cost >= 0) {
+        vars.round_start = vars.next_edge;
+        vars.round_length = std::min(chunk, m - scanned);
+        best_cost = run_pricing_round(new_edge, vars);
+        scanned += vars.round_length;
+        vars.next_edge = ((unsigned long long) vars.round_start + vars.round_length) % m;
+    }
+    return best_cost < 0;
+}
+
+// Dantzig's rule with the edges split evenly among the threads
+template<typename value_t>
+bool find_parallel_dantzig_edge(edge_t& new_edge, simplex_vars<value_t>& vars) {
+    vars.round_start = 0;
+    vars.round_length = vars.state.size();
+    return run_pricing_round(new_edge, vars) < 0;
+}
+
+// Finds a new edge to be added to the basis and returns whether an edge with negative reduced cost has been found
+template<typename value_t>
+bool find_new_edge(ResidualEdge& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
+    edge_t e;
+    bool found;
+    switch (vars.strategy) {
+    case FIRST_ELIGIBLE:
+        found = find_first_eligible_edge(e, g, vars);
+        break;
+    case CANDIDATE_LIST:
+        found = find_candidate_list_edge(e, g, vars);
+        break;
+    case DANTZIG:
+        found = vars.pool ? find_parallel_dantzig_edge(e, vars) : find_dantzig_edge(e, g, vars);
+        break;
+    case BLOCK_SEARCH:
+    default:
+        found = vars.pool ? find_parallel_block_search_edge(e, vars) : find_block_search_edge(e, g, vars);
+        break;
+    }
+
+    if (found) {
+        new_edge = ResidualEdge(g, e, vars.state[e] == STATE_LOWER);
+    }
+    return found;
+}
+
 // Gets the flow that can be augmented through the fundamental circuit containing the new edge
-void get_augmentable_flow_on_fundamental_circuit(flow_t& augmentable_flow, ResidualEdge& last_limiting_edge, bool& before_new_edge, ResidualEdge& new_edge, Graph& g, simplex_vars& vars) {
+template<typename value_t>
+void get_augmentable_flow_on_fundamental_circuit(flow_t& augmentable_flow, ResidualEdge& last_limiting_edge, bool& before_new_edge, ResidualEdge& new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
     node_t v = new_edge.v;
     node_t w = new_edge.w;
 
@@ -89,8 +450,8 @@ void get_augmentable_flow_on_fundamental_circuit(flow_t& augmentable_flow, Resid
 
     ResidualEdge resid_e;
     while (v != w) {
-        if (vars.dist[v] < vars.dist[w]) {
-            resid_e = ResidualEdge(g, vars.prev[w], w, true);
+        if (vars.tree.depth[v] < vars.tree.depth[w]) {
+            resid_e = ResidualEdge(g, vars.tree.prev[w], w, true);
             if (resid_e.pushable_flow(vars.flow) <= augmentable_flow) {
                 last_limiting_edge = resid_e;
                 before_new_edge = false;
@@ -98,7 +459,7 @@ void get_augmentable_flow_on_fundamental_circuit(flow_t& augmentable_flow, Resid
             }
             w = resid_e.w;
         } else {
-            resid_e = ResidualEdge(g, vars.prev[v], v, false);
+            resid_e = ResidualEdge(g, vars.tree.prev[v], v, false);
             if (resid_e.pushable_flow(vars.flow) < augmentable_flow) {
                 last_limiting_edge = resid_e;
                 before_new_edge = true;
@@ -110,7 +471,8 @@ void get_augmentable_flow_on_fundamental_circuit(flow_t& augmentable_flow, Resid
 }
 
 // augments the flow along the fundamental circuit and returns the last edge that limits the augmented value
-void augment_flow_and_update_previous_edges(ResidualEdge& e, flow_t value, ResidualEdge& last_limiting_edge, bool before_new_edge, Graph& g, simplex_vars& vars) {
+template<typename value_t>
+void augment_flow_and_update_previous_edges(ResidualEdge& e, flow_t value, ResidualEdge& last_limiting_edge, bool before_new_edge, BasicGraph<value_t>& g, simplex_vars<value_t>& vars) {
     node_t v = e.v;
     node_t w = e.w;
 
@@ -125,13 +487,13 @@ void augment_flow_and_update_previous_edges(ResidualEdge& e, flow_t value, Resid
     edge_t new_prev_before_new_edge = e.id;
     
     while (v != w) {
-        if (vars.dist[v] < vars.dist[w]) {
+        if (vars.tree.depth[v] < vars.tree.depth[w]) {
             if (new_prev_after_new_edge == last_limiting_edge.id) {
                 invert_previous_after_new_edge = false;
             }
-            resid_e = ResidualEdge(g, vars.prev[w], w, true);
+            resid_e = ResidualEdge(g, vars.tree.prev[w], w, true);
             if (invert_previous_after_new_edge) {
-                vars.prev[w] = new_prev_after_new_edge;
+                vars.tree.prev[w] = new_prev_after_new_edge;
                 new_prev_after_new_edge = resid_e.id;
             }
             resid_e.push(vars.flow, value);
@@ -140,9 +502,9 @@ void augment_flow_and_update_previous_edges(ResidualEdge& e, flow_t value, Resid
             if (new_prev_before_new_edge == last_limiting_edge.id) {
                 invert_previous_before_new_edge = false;
             }
-            resid_e = ResidualEdge(g, vars.prev[v], v, false);
+            resid_e = ResidualEdge(g, vars.tree.prev[v], v, false);
             if (invert_previous_before_new_edge) {
-                vars.prev[v] = new_prev_before_new_edge;
+                vars.tree.prev[v] = new_prev_before_new_edge;
                 new_prev_before_new_edge = resid_e.id;
             }
             resid_e.push(vars.flow, value);
@@ -151,39 +513,257 @@ void augment_flow_and_update_previous_edges(ResidualEdge& e, flow_t value, Resid
     }
 }
 
+// Adds the time since the previous lap to one of the phase counters if timings are enabled
+class phase_timer {
+public:
+    phase_timer(bool enabled) : enabled(enabled) {
+        if (enabled) {
+            last = std::chrono::steady_clock::now();
+        }
+    }
 
-// Returns a flow vector that solves the min cost flow problem on the given graph
-std::vector<flow_t> network_simplex(Graph& g) {
-    simplex_vars vars(g);
+    void lap(double& phase_time) {
+        if (enabled) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            phase_time += std::chrono::duration<double>(now - last).count();
+            last = now;
+        }
+    }
+
+    // Starts the next lap without adding the time since the previous one to any phase
+    void skip() {
+        if (enabled) {
+            last = std::chrono::steady_clock::now();
+        }
+    }
+
+private:
+    bool enabled;
+    std::chrono::steady_clock::time_point last;
+};
+
+template<typename value_t>
+BasicNetworkSimplex<value_t>::BasicNetworkSimplex(BasicGraph<value_t>& g, simplex_options& options) : g(g), options(options), vars(g) {
+    vars.strategy = options.strategy;
+    vars.kernel = select_pricing_kernel<value_t>(options.kernel);
 
     make_strongly_feasible_instance(g, vars);
-    
+    if (options.crash) {
+        crash_basis(g, vars);
+    }
+    init_pricing(g, vars);
+
+    // The pool lives as long as the solver, its threads wait for the next pricing round between pivots
+    if (options.threads > 1 && (options.strategy == BLOCK_SEARCH || options.strategy == DANTZIG)) {
+        pool.reset(new ThreadPool(options.threads));
+        vars.pool = pool.get();
+        vars.results.resize(options.threads);
+        vars.pricing_job = [this](unsigned int t) { scan_pricing_round(t, this->g, vars); };
+    }
+}
+
+// Removes the artificial edges from the graph again
+template<typename value_t>
+BasicNetworkSimplex<value_t>::~BasicNetworkSimplex() {
+    for (node_t i=0; i<g.node_count; i++) {
+        g.pop_edge();
+    }
+}
+
+// Runs the simplex from the current tree and returns the flow on the edges of the graph
+template<typename value_t>
+std::vector<flow_t> BasicNetworkSimplex<value_t>::solve(simplex_stats& stats) {
+    phase_timer timer(options.timings);
+
+    if (basis_changed) {
+        repair_basis(g, vars);
+    }
+    if (basis_changed || costs_changed) {
+        vars.tree.compute_potentials(g, vars.pot);
+    }
+    basis_changed = false;
+    costs_changed = false;
+    stats.value_bits = 8 * sizeof(value_t);
+    stats.kernel = pricing_kernel_name<value_t>(vars.kernel);
+    timer.lap(stats.init_time);
+
     ResidualEdge new_edge;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    simplex_progress progress;
+    double last_report = 0;
+    stats.status = OPTIMAL;
 
     while(find_new_edge(new_edge, g, vars)) {
+        timer.lap(stats.pricing_time);
+        if (options.pivot_limit > 0 && progress.pivots >= options.pivot_limit) {
+            stats.status = PIVOT_LIMIT;
+            break;
+        }
+        if (options.time_limit > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= options.time_limit) {
+            stats.status = TIME_LIMIT;
+            break;
+        }
+        if (options.progress_interval > 0 && progress.pivots > 0 && progress.pivots % options.progress_interval == 0 && options.progress) {
+            // The report and the callback belong to no phase
+            timer.lap(stats.pricing_time);
+            progress.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            progress.pivots_per_second = options.progress_interval / std::max(progress.elapsed - last_report, 1e-9);
+            last_report = progress.elapsed;
+            get_progress(progress, g, vars);
+            options.progress(progress);
+            timer.skip();
+        }
+        progress.pivots++;
+        stats.pivots++;
         flow_t augmentable_flow;
         ResidualEdge last_limiting_edge;
         bool before_new_edge;
         get_augmentable_flow_on_fundamental_circuit(augmentable_flow, last_limiting_edge, before_new_edge, new_edge, g, vars);
+        if (augmentable_flow == 0) {
+            stats.degenerate_pivots++;
+        }
+        timer.lap(stats.ratio_test_time);
+
+        // The deeper end of the leaving edge is the root of the subtree that gets cut off
+        node_t q = vars.tree.depth[last_limiting_edge.v] > vars.tree.depth[last_limiting_edge.w] ? last_limiting_edge.v : last_limiting_edge.w;
+
         augment_flow_and_update_previous_edges(new_edge, augmentable_flow, last_limiting_edge, before_new_edge, g, vars);
 
-        // Add the edge that has been removed from the tree to L or U, respectively
-        if (last_limiting_edge.forward) {
-            vars.U.push_front(last_limiting_edge.id);
-        } else {
-            vars.L.push_front(last_limiting_edge.id);
-        }
+        // The edge that has been removed from the tree is at its upper or lower bound, respectively
+        vars.state[new_edge.id] = STATE_TREE;
+        vars.state[last_limiting_edge.id] = last_limiting_edge.forward ? STATE_UPPER : STATE_LOWER;
 
-        update_potential_and_distance(g, vars);
+        // The tree only changes if the entering edge does not leave again
+        if (last_limiting_edge.id != new_edge.id) {
+            if (before_new_edge) {
+                vars.tree.rehang(new_edge.v, new_edge.w, q, g, vars.pot);
+            } else {
+                vars.tree.rehang(new_edge.w, new_edge.v, q, g, vars.pot);
+            }
+        }
+        timer.lap(stats.tree_update_time);
     }
+    timer.lap(stats.pricing_time);
 
+    stats.feasible = true;
     for (node_t i=0; i<g.node_count; i++) {
-        g.edges.pop_back();
-        if (vars.flow.back() > 0) {
-            throw(std::runtime_error("Did not find feasible solution."));
+        if (vars.flow[g.edge_count+i] > 0) {
+            stats.feasible = false;
         }
-        vars.flow.pop_back();
     }
+    if (stats.status == OPTIMAL && !stats.feasible) {
+        stats.status = INFEASIBLE;
+    }
+
+    return std::vector<flow_t>(vars.flow.begin(), vars.flow.begin() + g.edge_count);
+}
+
+// Gets the potentials of the real nodes for the current tree. With them every edge with flow strictly between its bounds
+// has reduced cost cost + pot[tail] - pot[head] = 0, edges at the lower bound have reduced cost >= 0 and edges at the upper
+// bound <= 0 once the solve is optimal.
+template<typename value_t>
+std::vector<pot_t> BasicNetworkSimplex<value_t>::potentials() {
+    return std::vector<pot_t>(vars.pot.begin(), vars.pot.begin() + g.node_count);
+}
+
+// Changes the cost of edge e. The artificial edges become more expensive if necessary to stay above every real path.
+template<typename value_t>
+void BasicNetworkSimplex<value_t>::update_cost(edge_t e, cost_t cost) {
+    if (e >= g.edge_count) {
+        throw(std::invalid_argument("Edge does not exist."));
+    }
+
+    check_value<value_t>(cost);
+    if (std::abs(cost) > vars.max_cost) {
+        check_value<value_t>(artificial_cost(g, std::abs(cost)));
+    }
+    g.cost[e] = cost;
+    if (std::abs(cost) > vars.max_cost) {
+        vars.max_cost = std::abs(cost);
+        cost_t big_m = artificial_cost(g, vars.max_cost);
+        for (node_t i=0; i<g.node_count; i++) {
+            g.cost[g.edge_count+i] = big_m;
+        }
+        costs_changed = true;
+    }
+    if (vars.state[e] == STATE_TREE) {
+        costs_changed = true;
+    }
+}
 
-    return vars.flow;
+// Changes the capacity of edge e, the flow of edges that are not at their lower bound has to be recomputed
+template<typename value_t>
+void BasicNetworkSimplex<value_t>::update_capacity(edge_t e, flow_t cap) {
+    if (e >= g.edge_count) {
+        throw(std::invalid_argument("Edge does not exist."));
+    }
+    if (cap < 0) {
+        throw(std::invalid_argument("Capacity must not be negative."));
+    }
+
+    check_value<value_t>(cap);
+    g.cap[e] = cap;
+    if (vars.state[e] != STATE_LOWER) {
+        basis_changed = true;
+    }
+}
+
+// Changes the supply of node v, the supplies have to be balanced again before the next solve
+template<typename value_t>
+void BasicNetworkSimplex<value_t>::update_supply(node_t v, supply_t supply) {
+    if (v >= g.node_count) {
+        throw(std::invalid_argument("Node does not exist."));
+    }
+
+    g.supply[v] = supply;
+    basis_changed = true;
+}
+
+// Returns a flow vector that solves the min cost flow problem on the given graph
+template<typename value_t>
+std::vector<flow_t> solve_network_simplex(BasicGraph<value_t>& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot) {
+    phase_timer timer(options.timings);
+    BasicNetworkSimplex<value_t> solver(g, options);
+    timer.lap(stats.init_time);
+    std::vector<flow_t> flow = solver.solve(stats);
+    if (pot != nullptr) {
+        *pot = solver.potentials();
+    }
+    return flow;
+}
+
+template class BasicNetworkSimplex<long long>;
+template class BasicNetworkSimplex<int>;
+template std::vector<flow_t> solve_network_simplex(Graph& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot);
+template std::vector<flow_t> solve_network_simplex(CompactGraph& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot);
+
+// Solves g with 32-bit capacities and costs if they fit and options.compact is set. The edges are moved into the
+// compact graph for the solve and back afterwards, so g has no edges while it runs.
+std::vector<flow_t> network_simplex(Graph& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot) {
+    if (options.compact && fits_compact(g)) {
+        phase_timer timer(options.timings);
+        CompactGraph compact = make_compact(g);
+        timer.lap(stats.init_time);
+        std::vector<flow_t> flow;
+        try {
+            flow = solve_network_simplex(compact, options, stats, pot);
+        } catch (...) {
+            restore_wide(compact, g);
+            throw;
+        }
+        restore_wide(compact, g);
+        return flow;
+    }
+    return solve_network_simplex(g, options, stats, pot);
+}
+
+std::vector<flow_t> network_simplex(Graph& g, pricing_strategy strategy) {
+    simplex_options options;
+    options.strategy = strategy;
+    simplex_stats stats;
+    std::vector<flow_t> flow = network_simplex(g, options, stats);
+    if (!stats.feasible) {
+        throw(std::runtime_error("Did not find feasible solution."));
+    }
+    return flow;
 }
\ No newline at end of file
@@ -2,20 +2,156 @@
 #define NETWORK_SIMPLEX_H
 
 #include "Graph.h"
+#include "PricingKernel.h"
 #include "ResidualEdge.h"
+#include "SpanningTree.h"
+#include "ThreadPool.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Rules for choosing the edge that enters the basis
+enum pricing_strategy {
+    FIRST_ELIGIBLE, // eligible edge with the smallest id
+    BLOCK_SEARCH,   // best edge of a block, the blocks rotate through the edges
+    CANDIDATE_LIST, // partial pricing on a list of candidates that is rebuilt from time to time
+    DANTZIG         // best edge among all edges
+};
+
+// Parses the name of a pricing strategy as given on the command line
+pricing_strategy parse_pricing_strategy(std::string name);
+
+// Outcome of a solve
+enum solve_status {
+    OPTIMAL,     // the returned flow is optimal
+    INFEASIBLE,  // artificial edges still carry flow at the optimum, the supplies cannot be met
+    TIME_LIMIT,  // stopped after simplex_options::time_limit, the flow is the current one
+    PIVOT_LIMIT  // stopped after simplex_options::pivot_limit pivots, the flow is the current one
+};
+
+std::string solve_status_name(solve_status status);
+
+// State of a running solve that is passed to the progress callback
+class simplex_progress {
+public:
+    unsigned long long pivots = 0; // pivots of the current solve
+    double elapsed = 0; // seconds since the start of the solve
+    double pivots_per_second = 0; // since the previous report
+    cost_t objective = 0; // cost of the flow on the real edges
+    node_t artificial_edges = 0; // artificial edges that still carry flow, the flow is feasible once there are none
+    flow_t artificial_flow = 0;
+};
+
+// Options of the network simplex
+class simplex_options {
+public:
+    pricing_strategy strategy = BLOCK_SEARCH;
+    unsigned int threads = 1; // threads that share the pricing (block search and Dantzig only)
+    std::string kernel = "auto"; // computes the reduced costs for block search and Dantzig (auto, scalar, avx2, avx512)
+    bool compact = true; // solve with 32-bit capacities and costs if they fit
+    bool crash = false; // start from a tree of real edges where possible instead of the all-artificial tree
+    bool timings = false; // measure the time of each phase (costs a few clock reads per pivot)
+
+    // progress is called every progress_interval pivots (never if 0)
+    unsigned long long progress_interval = 0;
+    std::function<void(simplex_progress&)> progress;
+
+    // A solve stops after this many seconds or pivots (no limit if 0) and returns the current flow
+    double time_limit = 0;
+    unsigned long long pivot_limit = 0;
+};
+
+// Best edge found by one pricing thread, padded to its own cache line
+class pricing_result {
+public:
+    cost_t cost;
+    edge_t edge;
+    char padding[64 - sizeof(cost_t) - sizeof(edge_t)];
+};
 
 // Contains all simplex variables
+template<typename value_t>
 class simplex_vars {
 public:
-    simplex_vars(Graph& g) : flow(g.edge_count + g.node_count, 0), prev(g.node_count+1, 0), pot(g.node_count+1, 0), dist(g.node_count+1, 0) { }
+    simplex_vars(BasicGraph<value_t>& g) : flow(g.edge_count + g.node_count, 0), state(g.edge_count + g.node_count, STATE_LOWER), pot(g.node_count+1, 0), tree(g.node_count) { }
 
     std::vector<flow_t> flow;
-    std::vector<edge_t> prev;
-    std::list<edge_t> L, U;
+    std::vector<edge_state_t> state;
     std::vector<pot_t> pot;
-    std::vector<unsigned int> dist; // distance (numbers of edges on the path from the root to each node)
+    SpanningTree tree;
+    cost_t max_cost = 0; // largest absolute cost of a real edge, determines the cost of the artificial edges
+
+    // state of the pricing rule
+    pricing_strategy strategy = BLOCK_SEARCH;
+    pricing_kernel_t<value_t> kernel = nullptr;
+    edge_t next_edge = 0; // where the next block or candidate scan starts
+    std::vector<edge_t> candidates;
+    unsigned int block_size = 0;
+    unsigned int list_length = 0;
+    unsigned int minor_limit = 0;
+    unsigned int minor_count = 0;
+
+    // parallel pricing, each round the threads split the edges round_start ... round_start+round_length (cyclically)
+    ThreadPool* pool = nullptr;
+    std::function<void(unsigned int)> pricing_job;
+    std::vector<pricing_result> results;
+    edge_t round_start = 0;
+    edge_t round_length = 0;
 };
 
-std::vector<flow_t> network_simplex(Graph& g);
+// Statistics of a run of the network simplex
+class simplex_stats {
+public:
+    solve_status status = OPTIMAL;
+    bool feasible = true; // the returned flow meets all supplies (it is optimal if status is OPTIMAL as well)
+    unsigned long long pivots = 0;
+    unsigned long long degenerate_pivots = 0; // pivots that do not change the flow
+    unsigned int value_bits = 0; // width of the capacities and costs the instance has been solved with
+    std::string kernel; // pricing kernel selected for that width
+
+    // seconds spent in each phase, only measured if simplex_options::timings is set
+    double init_time = 0;
+    double pricing_time = 0;
+    double ratio_test_time = 0;
+    double tree_update_time = 0;
+};
+
+// Network simplex that keeps its basis between solves.
+// A solve does not throw if the instance is infeasible or a limit is reached, the outcome is stats.status. The artificial edges are appended to g while the solver exists.
+// After changes of costs, capacities or supplies the next solve starts from the last optimal tree instead of the
+// all-artificial start.
+template<typename value_t>
+class BasicNetworkSimplex {
+public:
+    BasicNetworkSimplex(BasicGraph<value_t>& g, simplex_options& options);
+    ~BasicNetworkSimplex();
+    std::vector<flow_t> solve(simplex_stats& stats);
+    std::vector<pot_t> potentials();
+    void update_cost(edge_t e, cost_t cost);
+    void update_capacity(edge_t e, flow_t cap);
+    void update_supply(node_t v, supply_t supply);
+
+private:
+    BasicNetworkSimplex(const BasicNetworkSimplex&);
+    BasicNetworkSimplex& operator=(const BasicNetworkSimplex&);
+
+    BasicGraph<value_t>& g;
+    simplex_options options;
+    simplex_vars<value_t> vars;
+    std::unique_ptr<ThreadPool> pool;
+    bool basis_changed = false; // flows on the tree have to be recomputed
+    bool costs_changed = false; // potentials have to be recomputed
+};
+
+typedef BasicNetworkSimplex<long long> NetworkSimplex;
+
+// The potentials of the optimal tree are written to pot if it is given
+template<typename value_t>
+std::vector<flow_t> solve_network_simplex(BasicGraph<value_t>& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot = nullptr);
+// Throws if the instance has no feasible flow
+std::vector<flow_t> network_simplex(Graph& g, pricing_strategy strategy = BLOCK_SEARCH);
+std::vector<flow_t> network_simplex(Graph& g, simplex_options& options, simplex_stats& stats, std::vector<pot_t>* pot = nullptr);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,189 @@
+/* Preprocessing of instances and solving their weakly connected components independently */
+#include "Preprocess.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+// Drops zero capacity edges and self-loops, merges parallel edges with equal cost and splits the rest into weakly
+// connected components. Throws if the supplies of a component do not add up to zero.
+preprocessed_instance preprocess(Graph& g, preprocess_stats& stats) {
+    preprocessed_instance result;
+    result.fixed_flow.assign(g.edge_count, 0);
+
+    // Self-loops do not change the balance of their node, so they carry their whole capacity if that is profitable
+    std::vector<edge_t> edges;
+    for (edge_t e=0; e<g.edge_count; e++) {
+        if (g.cap[e] <= 0) {
+            stats.zero_cap_edges++;
+        } else if (g.tail[e] == g.head[e]) {
+            stats.self_loops++;
+            result.fixed_flow[e] = g.cost[e] < 0 ? g.cap[e] : 0;
+        } else {
+            edges.push_back(e);
+        }
+    }
+
+    // Parallel edges with equal cost are next to each other after sorting, each group becomes one edge
+    std::sort(edges.begin(), edges.end(), [&g](edge_t a, edge_t b) {
+        if (g.tail[a] != g.tail[b]) {
+            return g.tail[a] < g.tail[b];
+        }
+        if (g.head[a] != g.head[b]) {
+            return g.head[a] < g.head[b];
+        }
+        if (g.cost[a] != g.cost[b]) {
+            return g.cost[a] < g.cost[b];
+        }
+        return a < b;
+    });
+    std::vector<edge_t> group_start;
+    std::vector<flow_t> group_cap;
+    for (edge_t i=0; i<edges.size(); i++) {
+        edge_t e = edges[i];
+        bool parallel = i > 0 && g.tail[e] == g.tail[edges[i-1]] && g.head[e] == g.head[edges[i-1]] && g.cost[e] == g.cost[edges[i-1]];
+        // The merged capacity has to stay far away from overflows in the flow updates
+        if (parallel && group_cap.back() <= std::numeric_limits<flow_t>::max() / 4 - g.cap[e]) {
+            group_cap.back() += g.cap[e];
+            stats.merged_edges++;
+        } else {
+            group_start.push_back(i);
+            group_cap.push_back(g.cap[e]);
+        }
+    }
+    group_start.push_back(edges.size());
+    edge_t group_count = group_cap.size();
+
+    // Weakly connected components of the remaining edges, found by a search over the adjacency index of g.
+    // They are numbered in the order of their smallest node. Isolated nodes without supply are left out.
+    std::vector<bool> kept(g.edge_count, false);
+    std::vector<bool> used(g.node_count, false);
+    for (edge_t e : edges) {
+        kept[e] = true;
+        used[g.tail[e]] = true;
+        used[g.head[e]] = true;
+    }
+    Adjacency& adjacency = g.adjacency();
+    std::vector<node_t> component_id(g.node_count, g.node_count);
+    std::vector<node_t> local_id(g.node_count, 0);
+    std::vector<node_t> component_size;
+    std::vector<supply_t> component_supply;
+    std::vector<node_t> stack;
+    for (node_t s=0; s<g.node_count; s++) {
+        if ((!used[s] && g.supply[s] == 0) || component_id[s] != g.node_count) {
+            continue;
+        }
+        node_t c = component_size.size();
+        component_size.push_back(0);
+        component_supply.push_back(0);
+        component_id[s] = c;
+        stack.push_back(s);
+        while (!stack.empty()) {
+            node_t v = stack.back();
+            stack.pop_back();
+            for (edge_t k = adjacency.first_out[v]; k < adjacency.first_out[v+1]; k++) {
+                edge_t e = adjacency.out_edges[k];
+                if (e < g.edge_count && kept[e] && component_id[g.head[e]] == g.node_count) {
+                    component_id[g.head[e]] = c;
+                    stack.push_back(g.head[e]);
+                }
+            }
+            for (edge_t k = adjacency.first_in[v]; k < adjacency.first_in[v+1]; k++) {
+                edge_t e = adjacency.in_edges[k];
+                if (e < g.edge_count && kept[e] && component_id[g.tail[e]] == g.node_count) {
+                    component_id[g.tail[e]] = c;
+                    stack.push_back(g.tail[e]);
+                }
+            }
+        }
+    }
+    // Local ids follow the order of the nodes
+    for (node_t v=0; v<g.node_count; v++) {
+        if (component_id[v] != g.node_count) {
+            node_t c = component_id[v];
+            local_id[v] = component_size[c]++;
+            component_supply[c] += g.supply[v];
+        }
+    }
+    for (node_t c=0; c<component_size.size(); c++) {
+        if (component_supply[c] != 0) {
+            throw(std::runtime_error("Did not find feasible solution."));
+        }
+    }
+    stats.components = component_size.size();
+
+    std::vector<edge_t> component_edges(component_size.size(), 0);
+    for (edge_t k=0; k<group_count; k++) {
+        component_edges[component_id[g.tail[edges[group_start[k]]]]]++;
+    }
+    result.components.resize(component_size.size());
+    for (node_t c=0; c<component_size.size(); c++) {
+        // Room for the artificial edges of the network simplex
+        Graph& h = result.components[c].graph;
+        h = Graph(component_size[c]);
+        h.tail.reserve(component_edges[c] + component_size[c]);
+        h.head.reserve(component_edges[c] + component_size[c]);
+        h.cap.reserve(component_edges[c] + component_size[c]);
+        h.cost.reserve(component_edges[c] + component_size[c]);
+    }
+    for (node_t v=0; v<g.node_count; v++) {
+        if (component_id[v] != g.node_count) {
+            result.components[component_id[v]].graph.supply[local_id[v]] = g.supply[v];
+        }
+    }
+    for (edge_t k=0; k<group_count; k++) {
+        edge_t e = edges[group_start[k]];
+        component& comp = result.components[component_id[g.tail[e]]];
+        comp.graph.add_edge(local_id[g.tail[e]], local_id[g.head[e]], group_cap[k], g.cost[e]);
+        comp.graph.edge_count++;
+        comp.first_member.push_back(comp.members.size());
+        comp.members.insert(comp.members.end(), edges.begin() + group_start[k], edges.begin() + group_start[k+1]);
+    }
+    for (component& comp : result.components) {
+        comp.first_member.push_back(comp.members.size());
+    }
+    return result;
+}
+
+// Solves the components of the preprocessed instance on a pool of workers and maps their flows back to the edges of g.
+// The flow of a merged edge is spread over its members in order of their ids.
+std::vector<flow_t> solve_components(Graph& g, component_solver solve, unsigned int workers, preprocess_stats& stats) {
+    preprocessed_instance instance = preprocess(g, stats);
+    std::vector<flow_t> flow = instance.fixed_flow;
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::function<void(unsigned int)> job = [&](unsigned int) {
+        for (size_t c = next++; c < instance.components.size(); c = next++) {
+            component& comp = instance.components[c];
+            try {
+                std::vector<flow_t> component_flow = solve(comp.graph, c);
+                for (edge_t j=0; j<comp.graph.edge_count; j++) {
+                    flow_t remaining = component_flow[j];
+                    for (edge_t i = comp.first_member[j]; i < comp.first_member[j+1]; i++) {
+                        edge_t e = comp.members[i];
+                        flow[e] = std::min(remaining, g.cap[e]);
+                        remaining -= flow[e];
+                    }
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    ThreadPool pool(std::max(1u, std::min(workers, (unsigned int) std::max((size_t) 1, instance.components.size()))));
+    pool.run(job);
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return flow;
+}
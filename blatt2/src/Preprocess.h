@@ -0,0 +1,43 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include "Graph.h"
+
+#include <functional>
+#include <vector>
+
+// Weakly connected part of an instance that is solved on its own.
+// Edge j of graph stands for the original edges members[first_member[j]] ... members[first_member[j+1]-1],
+// which are parallel and have the same cost.
+class component {
+public:
+    component() : graph(0) { }
+
+    Graph graph;
+    std::vector<edge_t> first_member;
+    std::vector<edge_t> members;
+};
+
+// Statistics of the preprocessing
+class preprocess_stats {
+public:
+    edge_t zero_cap_edges = 0; // dropped, they never carry flow
+    edge_t self_loops = 0; // dropped, saturated if their cost is negative
+    edge_t merged_edges = 0; // parallel edges with equal cost that have been merged into another one
+    node_t components = 0;
+};
+
+// Instance after preprocessing: the components and the flow on the dropped edges
+class preprocessed_instance {
+public:
+    std::vector<component> components;
+    std::vector<flow_t> fixed_flow; // flow of the original edges that are not part of a component
+};
+
+// Solves the component with the given index, called concurrently for different components
+typedef std::function<std::vector<flow_t>(Graph&, node_t)> component_solver;
+
+preprocessed_instance preprocess(Graph& g, preprocess_stats& stats);
+std::vector<flow_t> solve_components(Graph& g, component_solver solve, unsigned int workers, preprocess_stats& stats);
+
+#endif
@@ -0,0 +1,212 @@
+/* Reduced cost kernels of the pricing, vectorized versions are selected at runtime */
+#include "PricingKernel.h"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+template<typename value_t>
+cost_t price_range_scalar(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge) {
+    cost_t best_cost = 0;
+    for (edge_t e = from; e < to; e++) {
+        cost_t c = state[e] * ((cost_t) cost[e] + pot[tail[e]] - pot[head[e]]);
+        if (c < best_cost) {
+            best_cost = c;
+            best_edge = e;
+        }
+    }
+    return best_cost;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+// Loads four costs widened to 64 bits
+__attribute__((target("avx2")))
+inline __m256i load_costs_avx2(const long long* cost) {
+    return _mm256_loadu_si256((const __m256i*) cost);
+}
+
+__attribute__((target("avx2")))
+inline __m256i load_costs_avx2(const int* cost) {
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) cost));
+}
+
+// Loads eight costs widened to 64 bits
+__attribute__((target("avx512f")))
+inline __m512i load_costs_avx512(const long long* cost) {
+    return _mm512_loadu_si512((const void*) cost);
+}
+
+__attribute__((target("avx512f")))
+inline __m512i load_costs_avx512(const int* cost) {
+    return _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*) cost));
+}
+
+// Four edges per step: the potentials are gathered, the sign of the state is applied by (c ^ neg) - neg and
+// tree edges are masked to 0. Every lane keeps its own minimum, ties keep the earlier edge.
+template<typename value_t>
+__attribute__((target("avx2")))
+cost_t price_range_avx2(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i best = zero;
+    __m256i best_idx = zero;
+    __m256i idx = _mm256_set_epi64x(from+3, from+2, from+1, from);
+
+    edge_t e = from;
+    for (; e + 4 <= to; e += 4) {
+        __m128i t = _mm_loadu_si128((const __m128i*) (tail + e));
+        __m128i h = _mm_loadu_si128((const __m128i*) (head + e));
+        __m256i pt = _mm256_i32gather_epi64((const long long*) pot, t, 8);
+        __m256i ph = _mm256_i32gather_epi64((const long long*) pot, h, 8);
+        __m256i c = load_costs_avx2(cost + e);
+        c = _mm256_sub_epi64(_mm256_add_epi64(c, pt), ph);
+
+        int packed_state;
+        __builtin_memcpy(&packed_state, state + e, sizeof(packed_state));
+        __m256i s = _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(packed_state));
+        __m256i neg = _mm256_cmpgt_epi64(zero, s);
+        __m256i tree = _mm256_cmpeq_epi64(s, zero);
+        c = _mm256_andnot_si256(tree, _mm256_sub_epi64(_mm256_xor_si256(c, neg), neg));
+
+        __m256i better = _mm256_cmpgt_epi64(best, c);
+        best = _mm256_blendv_epi8(best, c, better);
+        best_idx = _mm256_blendv_epi8(best_idx, idx, better);
+        idx = _mm256_add_epi64(idx, step);
+    }
+
+    long long lane_cost[4], lane_idx[4];
+    _mm256_storeu_si256((__m256i*) lane_cost, best);
+    _mm256_storeu_si256((__m256i*) lane_idx, best_idx);
+    cost_t best_cost = 0;
+    for (int i = 0; i < 4; i++) {
+        if (lane_cost[i] < best_cost || (lane_cost[i] == best_cost && lane_cost[i] < 0 && (edge_t) lane_idx[i] < best_edge)) {
+            best_cost = lane_cost[i];
+            best_edge = lane_idx[i];
+        }
+    }
+
+    // remaining edges
+    edge_t rest_edge = 0;
+    cost_t rest_cost = price_range_scalar(state, cost, tail, head, pot, e, to, rest_edge);
+    if (rest_cost < best_cost) {
+        best_cost = rest_cost;
+        best_edge = rest_edge;
+    }
+    return best_cost;
+}
+
+// Same as the AVX2 kernel with eight edges per step and mask registers
+template<typename value_t>
+__attribute__((target("avx512f")))
+cost_t price_range_avx512(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i step = _mm512_set1_epi64(8);
+    __m512i best = zero;
+    __m512i best_idx = zero;
+    __m512i idx = _mm512_set_epi64(from+7, from+6, from+5, from+4, from+3, from+2, from+1, from);
+
+    edge_t e = from;
+    for (; e + 8 <= to; e += 8) {
+        __m256i t = _mm256_loadu_si256((const __m256i*) (tail + e));
+        __m256i h = _mm256_loadu_si256((const __m256i*) (head + e));
+        __m512i pt = _mm512_i32gather_epi64(t, (const long long*) pot, 8);
+        __m512i ph = _mm512_i32gather_epi64(h, (const long long*) pot, 8);
+        __m512i c = load_costs_avx512(cost + e);
+        c = _mm512_sub_epi64(_mm512_add_epi64(c, pt), ph);
+
+        long long packed_state;
+        __builtin_memcpy(&packed_state, state + e, sizeof(packed_state));
+        __m512i s = _mm512_cvtepi8_epi64(_mm_cvtsi64_si128(packed_state));
+        __mmask8 neg = _mm512_cmplt_epi64_mask(s, zero);
+        __mmask8 basic = _mm512_cmpeq_epi64_mask(s, zero);
+        c = _mm512_mask_sub_epi64(c, neg, zero, c);
+        c = _mm512_mask_mov_epi64(c, basic, zero);
+
+        __mmask8 better = _mm512_cmplt_epi64_mask(c, best);
+        best = _mm512_mask_mov_epi64(best, better, c);
+        best_idx = _mm512_mask_mov_epi64(best_idx, better, idx);
+        idx = _mm512_add_epi64(idx, step);
+    }
+
+    long long lane_cost[8], lane_idx[8];
+    _mm512_storeu_si512((void*) lane_cost, best);
+    _mm512_storeu_si512((void*) lane_idx, best_idx);
+    cost_t best_cost = 0;
+    for (int i = 0; i < 8; i++) {
+        if (lane_cost[i] < best_cost || (lane_cost[i] == best_cost && lane_cost[i] < 0 && (edge_t) lane_idx[i] < best_edge)) {
+            best_cost = lane_cost[i];
+            best_edge = lane_idx[i];
+        }
+    }
+
+    edge_t rest_edge = 0;
+    cost_t rest_cost = price_range_scalar(state, cost, tail, head, pot, e, to, rest_edge);
+    if (rest_cost < best_cost) {
+        best_cost = rest_cost;
+        best_edge = rest_edge;
+    }
+    return best_cost;
+}
+
+#else
+
+template<typename value_t>
+cost_t price_range_avx2(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge) {
+    return price_range_scalar(state, cost, tail, head, pot, from, to, best_edge);
+}
+
+template<typename value_t>
+cost_t price_range_avx512(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge) {
+    return price_range_scalar(state, cost, tail, head, pot, from, to, best_edge);
+}
+
+#endif
+
+template<typename value_t>
+pricing_kernel_t<value_t> select_pricing_kernel(std::string name) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#else
+    bool avx2 = false;
+    bool avx512 = false;
+#endif
+
+    if (name == "auto") {
+        return avx512 ? price_range_avx512<value_t> : avx2 ? price_range_avx2<value_t> : price_range_scalar<value_t>;
+    } else if (name == "scalar") {
+        return price_range_scalar<value_t>;
+    } else if (name == "avx2" && avx2) {
+        return price_range_avx2<value_t>;
+    } else if (name == "avx512" && avx512) {
+        return price_range_avx512<value_t>;
+    } else if (name == "avx2" || name == "avx512") {
+        throw(std::runtime_error("The CPU does not support the pricing kernel " + name));
+    }
+    throw(std::invalid_argument("Unknown pricing kernel " + name));
+}
+
+template<typename value_t>
+std::string pricing_kernel_name(pricing_kernel_t<value_t> kernel) {
+    if (kernel == price_range_avx512<value_t>) {
+        return "avx512";
+    } else if (kernel == price_range_avx2<value_t>) {
+        return "avx2";
+    }
+    return "scalar";
+}
+
+template pricing_kernel_t<long long> select_pricing_kernel<long long>(std::string name);
+template pricing_kernel_t<int> select_pricing_kernel<int>(std::string name);
+template std::string pricing_kernel_name<long long>(pricing_kernel_t<long long> kernel);
+template std::string pricing_kernel_name<int>(pricing_kernel_t<int> kernel);
@@ -0,0 +1,32 @@
+#ifndef PRICING_KERNEL_H
+#define PRICING_KERNEL_H
+
+#include "Graph.h"
+
+#include <string>
+
+// State of an edge, chosen such that state * (cost + pot[tail] - pot[head]) < 0 iff the edge may enter the basis
+typedef signed char edge_state_t;
+const edge_state_t STATE_UPPER = -1;
+const edge_state_t STATE_TREE = 0;
+const edge_state_t STATE_LOWER = 1;
+
+// Finds the edge e in [from, to) with the most negative state[e] * (cost[e] + pot[tail[e]] - pot[head[e]]).
+// Returns that value and writes the edge to best_edge (the first one on ties), returns 0 if no value is negative.
+// The costs are stored as value_t (see BasicGraph), the reduced costs are computed with 64 bits.
+template<typename value_t>
+using pricing_kernel_t = cost_t (*)(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge);
+
+template<typename value_t>
+cost_t price_range_scalar(const edge_state_t* state, const value_t* cost, const node_t* tail, const node_t* head,
+    const pot_t* pot, edge_t from, edge_t to, edge_t& best_edge);
+
+// Gets the kernel by name (scalar, avx2, avx512) or the widest one the CPU supports for "auto".
+// The vectorized kernels are only reachable through this function, they are compiled for their instruction set alone.
+template<typename value_t>
+pricing_kernel_t<value_t> select_pricing_kernel(std::string name);
+template<typename value_t>
+std::string pricing_kernel_name(pricing_kernel_t<value_t> kernel);
+
+#endif
@@ -3,24 +3,25 @@
 ResidualEdge::ResidualEdge() { }
 
 // Creates a residual edge from the edge that has node as tail if tail == true or node as head otherwise
-ResidualEdge::ResidualEdge(Graph& g, edge_t e, node_t node, bool tail) : id(e), cap(g.edges[e].cap), cost(g.edges[e].cost) {
+template<typename value_t>
+ResidualEdge::ResidualEdge(BasicGraph<value_t>& g, edge_t e, node_t node, bool tail) : id(e), cap(g.cap[e]), cost(g.cost[e]) {
     if (tail) {
-        if (g.edges[e].v == node) {
+        if (g.tail[e] == node) {
             v = node;
-            w =  g.edges[e].w;
+            w =  g.head[e];
             forward = true;
         } else {
             v = node;
-            w = g.edges[e].v;
+            w = g.tail[e];
             forward = false;
         }
     } else {
-        if (g.edges[e].w == node) {
-            v = g.edges[e].v;
+        if (g.head[e] == node) {
+            v = g.tail[e];
             w = node;
             forward = true;
         } else {
-            v = g.edges[e].w;
+            v = g.head[e];
             w = node;
             forward = false;
         }
@@ -28,16 +29,22 @@ ResidualEdge::ResidualEdge(Graph& g, edge_t e, node_t node, bool tail) : id(e),
 }
 
 // Creates a residual edge from the edge into the same direction if foward == true or the opposite direction otherwise
-ResidualEdge::ResidualEdge(Graph& g, edge_t e, bool forward) : id(e), cap(g.edges[e].cap), cost(g.edges[e].cost), forward(forward) {
+template<typename value_t>
+ResidualEdge::ResidualEdge(BasicGraph<value_t>& g, edge_t e, bool forward) : id(e), cap(g.cap[e]), cost(g.cost[e]), forward(forward) {
     if (forward) {
-        v = g.edges[e].v;
-        w = g.edges[e].w;
+        v = g.tail[e];
+        w = g.head[e];
     } else {
-        v = g.edges[e].w;
-        w = g.edges[e].v;
+        v = g.head[e];
+        w = g.tail[e];
     }
 }
 
+template ResidualEdge::ResidualEdge(Graph& g, edge_t e, node_t node, bool tail);
+template ResidualEdge::ResidualEdge(CompactGraph& g, edge_t e, node_t node, bool tail);
+template ResidualEdge::ResidualEdge(Graph& g, edge_t e, bool forward);
+template ResidualEdge::ResidualEdge(CompactGraph& g, edge_t e, bool forward);
+
 // Gets the amount of flow that can be pushed through the residual edge
 flow_t ResidualEdge::pushable_flow(std::vector<flow_t>& flow) {
     return forward ? cap - flow[id] : flow[id];
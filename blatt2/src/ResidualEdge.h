@@ -6,8 +6,10 @@
 class ResidualEdge {
 public:
     ResidualEdge();
-    ResidualEdge(Graph& g, edge_t e, node_t node, bool tail);
-    ResidualEdge(Graph& g, edge_t e, bool forward);
+    template<typename value_t>
+    ResidualEdge(BasicGraph<value_t>& g, edge_t e, node_t node, bool tail);
+    template<typename value_t>
+    ResidualEdge(BasicGraph<value_t>& g, edge_t e, bool forward);
     flow_t pushable_flow(std::vector<flow_t>& flow);
     void push(std::vector<flow_t>& flow, flow_t value);
     cost_t potential_cost(std::vector<pot_t>& pot);
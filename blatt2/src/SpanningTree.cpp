@@ -0,0 +1,165 @@
+/* Spanning tree structure of the network simplex */
+#include "SpanningTree.h"
+#include "ResidualEdge.h"
+
+#include <stdexcept>
+
+// Builds parent, thread, succ_num and depth from the edges in prev
+template<typename value_t>
+void SpanningTree::build(BasicGraph<value_t>& g) {
+    node_t n = root + 1;
+
+    for (node_t i = 0; i < root; i++) {
+        parent[i] = g.tail[prev[i]] == i ? g.head[prev[i]] : g.tail[prev[i]];
+    }
+    parent[root] = root;
+
+    // Sort the nodes by their parent (counting sort) to get the children of each node
+    std::vector<node_t> first_child(n+1, 0);
+    for (node_t i = 0; i < root; i++) {
+        first_child[parent[i]+1]++;
+    }
+    for (node_t i = 0; i < n; i++) {
+        first_child[i+1] += first_child[i];
+    }
+    std::vector<node_t> children(root);
+    std::vector<node_t> next_child(first_child.begin(), first_child.end()-1);
+    for (node_t i = 0; i < root; i++) {
+        children[next_child[parent[i]]++] = i;
+    }
+
+    // Preorder with an explicit stack
+    order.clear();
+    std::vector<node_t> stack(1, root);
+    while (!stack.empty()) {
+        node_t u = stack.back();
+        stack.pop_back();
+        order.push_back(u);
+        for (node_t i = first_child[u+1]; i > first_child[u]; i--) {
+            stack.push_back(children[i-1]);
+        }
+    }
+    if (order.size() != n) {
+        throw(std::runtime_error("The edges in prev do not form a spanning tree."));
+    }
+
+    for (node_t i = 0; i < n; i++) {
+        thread[order[i]] = order[(i+1) % n];
+        rev_thread[order[(i+1) % n]] = order[i];
+    }
+
+    // Children come after their parents in the preorder
+    depth[root] = 0;
+    for (node_t i = 1; i < n; i++) {
+        depth[order[i]] = depth[parent[order[i]]] + 1;
+    }
+    for (node_t i = 0; i < n; i++) {
+        succ_num[i] = 1;
+    }
+    for (node_t i = n-1; i > 0; i--) {
+        succ_num[parent[order[i]]] += succ_num[order[i]];
+    }
+}
+
+// Sets the potentials such that all tree edges have reduced cost 0, the root has potential 0
+template<typename value_t>
+void SpanningTree::compute_potentials(BasicGraph<value_t>& g, std::vector<pot_t>& pot) {
+    pot[root] = 0;
+    for (node_t x = thread[root]; x != root; x = thread[x]) {
+        pot[x] = pot[parent[x]] + ResidualEdge(g, prev[x], x, false).residual_cost();
+    }
+}
+
+// Moves the subtree that has been cut off by removing the leaving edge below the entering edge.
+// u_in is the end of the entering edge inside the subtree, v_in the one outside of it and q the old root of the subtree.
+// The edges in prev have to be updated already, parent, thread and succ_num still describe the old tree.
+// Only the moved subtree and the paths to the root are touched.
+template<typename value_t>
+void SpanningTree::rehang(node_t u_in, node_t v_in, node_t q, BasicGraph<value_t>& g, std::vector<pot_t>& pot) {
+    node_t size = succ_num[q];
+
+    // Remove the subtree from the thread
+    node_t last = q;
+    for (node_t i = 1; i < size; i++) {
+        last = thread[last];
+    }
+    node_t before = rev_thread[q];
+    node_t after = thread[last];
+    thread[before] = after;
+    rev_thread[after] = before;
+
+    for (node_t u = parent[q]; u != root; u = parent[u]) {
+        succ_num[u] -= size;
+    }
+    succ_num[root] -= size;
+
+    // Preorder of the subtree rooted at u_in: walk the stem u_in ... q and append each stem node followed by
+    // its old subtree without the part that contains the previous stem node
+    order.clear();
+    node_t skip = root, skip_end = root; // previous stem node and the node behind its old subtree in the thread
+    for (node_t x = u_in; ; x = parent[x]) {
+        order.push_back(x);
+        node_t remaining = succ_num[x] - 1;
+        node_t u = thread[x];
+        while (remaining > 0) {
+            if (u == skip) {
+                u = skip_end;
+                remaining -= succ_num[skip];
+            } else {
+                order.push_back(u);
+                u = thread[u];
+                remaining--;
+            }
+        }
+        skip = x;
+        skip_end = u;
+        if (x == q) {
+            break;
+        }
+    }
+
+    // Reverse the parents and subtree sizes on the stem
+    node_t new_parent = v_in;
+    node_t removed = 0;
+    for (node_t x = u_in; ; ) {
+        node_t old_parent = parent[x];
+        node_t old_size = succ_num[x];
+        parent[x] = new_parent;
+        succ_num[x] = size - removed;
+        removed = old_size;
+        if (x == q) {
+            break;
+        }
+        new_parent = x;
+        x = old_parent;
+    }
+
+    // Insert the subtree behind v_in
+    after = thread[v_in];
+    node_t prev_node = v_in;
+    for (node_t x : order) {
+        thread[prev_node] = x;
+        rev_thread[x] = prev_node;
+        prev_node = x;
+    }
+    thread[prev_node] = after;
+    rev_thread[after] = prev_node;
+
+    for (node_t u = v_in; u != root; u = parent[u]) {
+        succ_num[u] += size;
+    }
+    succ_num[root] += size;
+
+    // Parents come before their children in the preorder
+    for (node_t x : order) {
+        depth[x] = depth[parent[x]] + 1;
+        pot[x] = pot[parent[x]] + ResidualEdge(g, prev[x], x, false).residual_cost();
+    }
+}
+
+template void SpanningTree::build(Graph& g);
+template void SpanningTree::build(CompactGraph& g);
+template void SpanningTree::compute_potentials(Graph& g, std::vector<pot_t>& pot);
+template void SpanningTree::compute_potentials(CompactGraph& g, std::vector<pot_t>& pot);
+template void SpanningTree::rehang(node_t u_in, node_t v_in, node_t q, Graph& g, std::vector<pot_t>& pot);
+template void SpanningTree::rehang(node_t u_in, node_t v_in, node_t q, CompactGraph& g, std::vector<pot_t>& pot);
@@ -0,0 +1,33 @@
+#ifndef SPANNING_TREE_H
+#define SPANNING_TREE_H
+
+#include "Graph.h"
+
+#include <vector>
+
+// Spanning tree of the network simplex, rooted at the artificial node g.node_count.
+// All traversals are iterative and walk the preorder thread, so the depth of the tree is not limited by the stack.
+class SpanningTree {
+public:
+    SpanningTree(node_t node_count) : root(node_count), prev(node_count+1, 0), parent(node_count+1, node_count), depth(node_count+1, 0),
+        thread(node_count+1, 0), rev_thread(node_count+1, 0), succ_num(node_count+1, 1) { }
+
+    template<typename value_t>
+    void build(BasicGraph<value_t>& g);
+    template<typename value_t>
+    void compute_potentials(BasicGraph<value_t>& g, std::vector<pot_t>& pot);
+    template<typename value_t>
+    void rehang(node_t u_in, node_t v_in, node_t q, BasicGraph<value_t>& g, std::vector<pot_t>& pot);
+
+    node_t root;
+    std::vector<edge_t> prev; // edge to the parent of each node
+    std::vector<node_t> parent; // node at the other end of prev
+    std::vector<unsigned int> depth; // numbers of edges on the path from the root to each node
+    std::vector<node_t> thread, rev_thread; // successor and predecessor in the preorder of the tree, cyclic through the root
+    std::vector<node_t> succ_num; // number of nodes in the subtree of each node (including the node)
+
+private:
+    std::vector<node_t> order; // scratch space for building and re-hanging subtrees
+};
+
+#endif
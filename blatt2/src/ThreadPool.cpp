@@ -0,0 +1,77 @@
+#include "ThreadPool.h"
+
+// Number of polls of a worker before it goes to sleep, jobs of the simplex follow each other closely
+const unsigned int SPIN_COUNT = 2000;
+
+ThreadPool::ThreadPool(unsigned int thread_count) : generation(0), running(0) {
+    for (unsigned int i = 1; i < thread_count; i++) {
+        workers.push_back(std::thread(&ThreadPool::worker, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        generation++;
+    }
+    start_cv.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+// Gets the number of threads including the calling one
+unsigned int ThreadPool::size() {
+    return workers.size() + 1;
+}
+
+void ThreadPool::run(std::function<void(unsigned int)>& job) {
+    if (workers.empty()) {
+        job(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        running = workers.size();
+        generation++;
+    }
+    start_cv.notify_all();
+
+    job(0);
+
+    for (unsigned int i = 0; i < SPIN_COUNT && running.load() != 0; i++) {
+        std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return running.load() == 0; });
+}
+
+void ThreadPool::worker(unsigned int index) {
+    unsigned long long seen = 0;
+    while (true) {
+        for (unsigned int i = 0; i < SPIN_COUNT && generation.load() == seen; i++) {
+            std::this_thread::yield();
+        }
+
+        std::function<void(unsigned int)>* current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [this, seen] { return generation.load() != seen; });
+            seen = generation.load();
+            if (stop) {
+                return;
+            }
+            current = job;
+        }
+
+        (*current)(index);
+
+        if (running.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done_cv.notify_one();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent fork-join pool. run() executes a job on every thread of the pool (the calling thread takes index 0)
+// and returns once all of them are done. The workers stay alive between jobs, so a run costs a wake-up, not a thread start.
+class ThreadPool {
+public:
+    ThreadPool(unsigned int thread_count);
+    ~ThreadPool();
+    unsigned int size();
+    void run(std::function<void(unsigned int)>& job);
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+    void worker(unsigned int index);
+
+    std::vector<std::thread> workers;
+    std::function<void(unsigned int)>* job = nullptr;
+    std::mutex mutex;
+    std::condition_variable start_cv, done_cv;
+    std::atomic<unsigned long long> generation;
+    std::atomic<unsigned int> running;
+    bool stop = false;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/* Checks min cost flow solutions against their instance */
+#include "Verify.h"
+#include "IntegerScanner.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+bool read_solution(std::string filename, Graph& g, cost_t& objective, std::vector<flow_t>& flow, std::vector<pot_t>& pot) {
+    IntegerScanner file(filename);
+    long long e = 0, f;
+    if (!file.next(objective)) {
+        throw(std::runtime_error("Solution file is empty."));
+    }
+    flow.assign(g.edge_count, 0);
+    while (file.next(e)) {
+        if (e == -1) {
+            break;
+        }
+        if (!file.next(f)) {
+            throw(std::runtime_error("Solution file ends within a flow."));
+        }
+        if (e < 0 || e >= (long long) g.edge_count) {
+            throw(std::runtime_error("Solution contains edge " + std::to_string(e) + ", which does not exist."));
+        }
+        flow[e] = f;
+    }
+    if (e != -1) {
+        return false;
+    }
+
+    pot.resize(g.node_count);
+    for (node_t i=0; i<g.node_count; i++) {
+        if (!file.next(pot[i])) {
+            throw(std::runtime_error("Solution file ends before the potential of the last node."));
+        }
+    }
+    return true;
+}
+
+// Result of one thread, the balance holds outflow - inflow of every node for the edges of the thread
+class verify_share {
+public:
+    std::vector<flow_t> balance;
+    edge_t bound_violations = 0;
+    node_t conservation_violations = 0;
+    edge_t slackness_violations = 0;
+    cost_t objective = 0;
+    std::string first_error;
+};
+
+verify_result verify_solution(Graph& g, std::vector<flow_t>& flow, std::vector<pot_t>* pot, unsigned int threads) {
+    threads = std::max(1u, threads);
+    std::vector<verify_share> shares(threads);
+
+    // Each thread checks a contiguous range of edges, the first violation of a range is the one with the lowest id
+    std::function<void(unsigned int)> check_edges = [&](unsigned int t) {
+        verify_share& share = shares[t];
+        share.balance.assign(g.node_count, 0);
+        edge_t from = (unsigned long long) g.edge_count * t / threads;
+        edge_t to = (unsigned long long) g.edge_count * (t+1) / threads;
+        for (edge_t e = from; e < to; e++) {
+            flow_t f = flow[e];
+            share.balance[g.tail[e]] += f;
+            share.balance[g.head[e]] -= f;
+            share.objective += g.cost[e] * f;
+
+            if (f < 0 || f > g.cap[e]) {
+                if (share.bound_violations++ == 0 && share.first_error.empty()) {
+                    share.first_error = "edge " + std::to_string(e) + " has flow " + std::to_string(f) + " but capacity " + std::to_string(g.cap[e]);
+                }
+            } else if (pot != nullptr) {
+                cost_t reduced = g.cost[e] + (*pot)[g.tail[e]] - (*pot)[g.head[e]];
+                if ((reduced > 0 && f > 0) || (reduced < 0 && f < g.cap[e])) {
+                    if (share.slackness_violations++ == 0 && share.first_error.empty()) {
+                        share.first_error = "edge " + std::to_string(e) + " has flow " + std::to_string(f) + " but reduced cost " + std::to_string(reduced);
+                    }
+                }
+            }
+        }
+    };
+
+    // Afterwards each thread adds up the balances of a range of nodes
+    std::function<void(unsigned int)> check_nodes = [&](unsigned int t) {
+        verify_share& share = shares[t];
+        node_t from = (unsigned long long) g.node_count * t / threads;
+        node_t to = (unsigned long long) g.node_count * (t+1) / threads;
+        for (node_t v = from; v < to; v++) {
+            flow_t balance = 0;
+            for (verify_share& other : shares) {
+                balance += other.balance[v];
+            }
+            if (balance != g.supply[v]) {
+                if (share.conservation_violations++ == 0) {
+                    share.first_error = "node " + std::to_string(v) + " sends " + std::to_string(balance) + " but has supply " + std::to_string(g.supply[v]);
+                }
+            }
+        }
+    };
+
+    ThreadPool pool(threads);
+    pool.run(check_edges);
+    std::vector<std::string> edge_errors(threads);
+    for (unsigned int t = 0; t < threads; t++) {
+        edge_errors[t] = shares[t].first_error;
+        shares[t].first_error.clear();
+    }
+    pool.run(check_nodes);
+
+    verify_result result;
+    for (unsigned int t = 0; t < threads; t++) {
+        result.bound_violations += shares[t].bound_violations;
+        result.slackness_violations += shares[t].slackness_violations;
+        result.conservation_violations += shares[t].conservation_violations;
+        result.objective += shares[t].objective;
+        if (result.first_error.empty()) {
+            result.first_error = edge_errors[t];
+        }
+    }
+    for (unsigned int t = 0; t < threads && result.first_error.empty(); t++) {
+        result.first_error = shares[t].first_error;
+    }
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "Graph.h"
+
+#include <string>
+#include <vector>
+
+// Outcome of checking a flow (and optionally potentials) against an instance
+class verify_result {
+public:
+    edge_t bound_violations = 0; // edges whose flow is negative or above the capacity
+    node_t conservation_violations = 0; // nodes where outflow - inflow differs from the supply
+    edge_t slackness_violations = 0; // edges whose flow does not fit the sign of their reduced cost
+    cost_t objective = 0; // cost of the flow
+    std::string first_error; // description of the first violation that has been found
+
+    bool passed() {
+        return bound_violations == 0 && conservation_violations == 0 && slackness_violations == 0 && first_error.empty();
+    }
+};
+
+// Reads a solution written by export_min_cost_flow: the stated objective, the flow of every edge and the potentials
+// if the solution has them. Returns whether it has.
+bool read_solution(std::string filename, Graph& g, cost_t& objective, std::vector<flow_t>& flow, std::vector<pot_t>& pot);
+
+// Checks capacity bounds, flow conservation and, if pot is given, complementary slackness with the reduced costs
+// cost + pot[tail] - pot[head]. The edges and nodes are split among the given number of threads.
+verify_result verify_solution(Graph& g, std::vector<flow_t>& flow, std::vector<pot_t>* pot, unsigned int threads);
+
+#endif
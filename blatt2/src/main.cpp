@@ -1,35 +1,566 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include "Batch.h"
+#include "CostScaling.h"
 #include "NetworkSimplex.h"
+#include "Preprocess.h"
+#include "Verify.h"
+
+// Gets the cost of a flow
+cost_t flow_cost(Graph& g, std::vector<flow_t>& flow) {
+    cost_t value = 0;
+    for (edge_t e=0; e<g.edge_count; e++) {
+        value += g.cost[e] * flow[e];
+    }
+    return value;
+}
+
+// Appends the statistics of one run to a CSV file (with a header if the file is new) or, if the name ends with
+// .json, a JSON object per line
+void write_run_stats(std::string path, std::string instance, std::string engine, simplex_options& options, simplex_stats& stats,
+        double parse_time, double export_time, cost_t objective) {
+    bool json = path.size() >= 5 && path.compare(path.size()-5, 5, ".json") == 0;
+    bool empty;
+    {
+        std::ifstream existing(path);
+        empty = !existing.is_open() || existing.peek() == std::ifstream::traits_type::eof();
+    }
+    std::ofstream out(path, std::ios_base::app);
+    if (!out.is_open()) {
+        throw(std::runtime_error("Statistics file could not be opened."));
+    }
+
+    const char* strategies[] = {"first", "block", "candidate", "dantzig"};
+    const char* names[] = {"instance", "engine", "strategy", "threads", "kernel", "value_bits", "objective", "pivots", "degenerate_pivots",
+        "parse_time", "init_time", "pricing_time", "ratio_test_time", "tree_update_time", "export_time", "status"};
+    std::string values[] = {instance, engine, strategies[options.strategy], std::to_string(options.threads),
+        stats.kernel, std::to_string(stats.value_bits), std::to_string(objective), std::to_string(stats.pivots),
+        std::to_string(stats.degenerate_pivots), std::to_string(parse_time), std::to_string(stats.init_time),
+        std::to_string(stats.pricing_time), std::to_string(stats.ratio_test_time),
+        std::to_string(stats.tree_update_time), std::to_string(export_time), solve_status_name(stats.status)};
+    const int fields = sizeof(names) / sizeof(names[0]);
+
+    if (json) {
+        out << "{";
+        for (int i=0; i<fields; i++) {
+            // Instance, engine, strategy, kernel and status are strings, the rest are numbers
+            bool quoted = i <= 2 || i == 4 || i == fields-1;
+            out << (i > 0 ? ", " : "") << '"' << names[i] << "\": ";
+            out << (quoted ? "\"" + values[i] + "\"" : values[i]);
+        }
+        out << "}" << std::endl;
+    } else {
+        if (empty) {
+            for (int i=0; i<fields; i++) {
+                out << (i > 0 ? "," : "") << names[i];
+            }
+            out << std::endl;
+        }
+        for (int i=0; i<fields; i++) {
+            out << (i > 0 ? "," : "") << values[i];
+        }
+        out << std::endl;
+    }
+}
+
+// Throws if a solve has not ended with an optimal flow
+void require_optimal(simplex_stats& stats) {
+    if (stats.status == INFEASIBLE) {
+        throw(std::runtime_error("Did not find feasible solution."));
+    } else if (stats.status != OPTIMAL) {
+        throw(std::runtime_error("Solve stopped early: " + solve_status_name(stats.status)));
+    }
+}
+
+// Throws if a solve has not ended with a feasible flow
+void require_feasible(simplex_stats& stats) {
+    if (stats.status == INFEASIBLE) {
+        throw(std::runtime_error("Did not find feasible solution."));
+    } else if (!stats.feasible) {
+        throw(std::runtime_error("Solve stopped early (" + solve_status_name(stats.status) + ") before the flow became feasible."));
+    }
+}
+
+// Solves the instance with both engines and compares the objective values
+bool run_engine_cross_check(Graph& g, simplex_options& options) {
+    auto start = std::chrono::steady_clock::now();
+    simplex_stats simplex_run;
+    std::vector<flow_t> simplex_flow = network_simplex(g, options, simplex_run);
+    require_optimal(simplex_run);
+    std::chrono::duration<double> simplex_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    cost_scaling_stats scaling_run;
+    std::vector<flow_t> scaling_flow = cost_scaling(g, scaling_run);
+    std::chrono::duration<double> scaling_time = std::chrono::steady_clock::now() - start;
+
+    cost_t simplex_value = flow_cost(g, simplex_flow);
+    cost_t scaling_value = flow_cost(g, scaling_flow);
+    std::cout << "simplex: " << simplex_value << " in " << simplex_time.count() << "s (" << simplex_run.pivots << " pivots)" << std::endl;
+    std::cout << "cost scaling: " << scaling_value << " in " << scaling_time.count() << "s (" << scaling_run.pushes << " pushes, "
+        << scaling_run.relabels << " relabels)" << std::endl;
+    return simplex_value == scaling_value;
+}
+
+// Changes a few costs, capacities and supplies per round, re-optimizes warm and compares with a cold solve
+bool run_warm_start_benchmark(Graph& g, simplex_options& options, unsigned int rounds) {
+    Graph cold_graph = g;
+    NetworkSimplex solver(g, options);
+
+    simplex_stats stats;
+    auto start = std::chrono::steady_clock::now();
+    solver.solve(stats);
+    require_optimal(stats);
+    std::chrono::duration<double> first_time = std::chrono::steady_clock::now() - start;
+    std::cout << "first solve: " << first_time.count() << "s, " << stats.pivots << " pivots" << std::endl;
+
+    unsigned long long seed = 4711;
+    auto random = [&seed](unsigned long long bound) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (seed >> 33) % bound;
+    };
+
+    double warm_total = 0, cold_total = 0;
+    unsigned long long warm_pivots = 0, cold_pivots = 0;
+    for (unsigned int r=0; r<rounds; r++) {
+        for (int k=0; k<3; k++) {
+            edge_t e = random(g.edge_count);
+            cost_t cost = g.cost[e] + (cost_t) random(21) - 10;
+            solver.update_cost(e, cost);
+            cold_graph.cost[e] = cost;
+
+            e = random(g.edge_count);
+            flow_t cap = std::max((flow_t) 0, g.cap[e] + (flow_t) random(11) - 5);
+            solver.update_capacity(e, cap);
+            cold_graph.cap[e] = cap;
+        }
+        node_t u = random(g.node_count), v = random(g.node_count);
+        supply_t d = 1 + random(5);
+        solver.update_supply(u, g.supply[u] + d);
+        cold_graph.supply[u] += d;
+        solver.update_supply(v, g.supply[v] - d);
+        cold_graph.supply[v] -= d;
+
+        bool warm_feasible, cold_feasible;
+        cost_t warm_value = 0, cold_value = 0;
+        simplex_stats warm_stats, cold_stats;
+
+        start = std::chrono::steady_clock::now();
+        std::vector<flow_t> flow = solver.solve(warm_stats);
+        warm_feasible = warm_stats.status == OPTIMAL;
+        warm_value = warm_feasible ? flow_cost(g, flow) : 0;
+        std::chrono::duration<double> warm_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        flow = network_simplex(cold_graph, options, cold_stats);
+        cold_feasible = cold_stats.status == OPTIMAL;
+        cold_value = cold_feasible ? flow_cost(cold_graph, flow) : 0;
+        std::chrono::duration<double> cold_time = std::chrono::steady_clock::now() - start;
+
+        if (warm_feasible != cold_feasible || warm_value != cold_value) {
+            std::cout << "round " << r << ": warm start found " << warm_value << ", cold start " << cold_value << std::endl;
+            return false;
+        }
+        warm_total += warm_time.count();
+        cold_total += cold_time.count();
+        warm_pivots += warm_stats.pivots;
+        cold_pivots += cold_stats.pivots;
+    }
+
+    std::cout << "warm re-solve: " << warm_total / rounds << "s, " << warm_pivots / rounds << " pivots on average" << std::endl;
+    std::cout << "cold re-solve: " << cold_total / rounds << "s, " << cold_pivots / rounds << " pivots on average" << std::endl;
+    return true;
+}
+
+// Compares the pricing kernels on the edges of g with pseudo-random states and potentials. The first kernel that runs
+// sets the reference result, so calls for graphs with different value widths are compared with each other as well.
+template<typename value_t>
+bool run_pricing_benchmark(BasicGraph<value_t>& g, cost_t& reference_cost, edge_t& reference_edge, bool& has_reference) {
+    edge_t m = g.edge_count;
+    std::vector<edge_state_t> state(m);
+    std::vector<pot_t> pot(g.node_count+1);
+    unsigned long long seed = 12345;
+    for (edge_t e=0; e<m; e++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        state[e] = (edge_state_t) ((seed >> 33) % 3) - 1;
+    }
+    for (node_t i=0; i<=g.node_count; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        pot[i] = (pot_t) ((seed >> 33) % 2000001) - 1000000;
+    }
+
+    unsigned int repetitions = std::max(1u, (unsigned int) (200000000ULL / std::max(m, 1u)));
+    const char* names[] = {"scalar", "avx2", "avx512"};
+    bool agree = true;
+    for (int k=0; k<3; k++) {
+        pricing_kernel_t<value_t> kernel;
+        try {
+            kernel = select_pricing_kernel<value_t>(names[k]);
+        } catch (std::runtime_error& e) {
+            std::cout << names[k] << ": not supported" << std::endl;
+            continue;
+        }
+
+        cost_t c = 0;
+        edge_t best = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int r=0; r<repetitions; r++) {
+            c = kernel(state.data(), g.cost.data(), g.tail.data(), g.head.data(), pot.data(), 0, m, best);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!has_reference) {
+            reference_cost = c;
+            reference_edge = best;
+            has_reference = true;
+        } else if (c != reference_cost || (c < 0 && best != reference_edge)) {
+            agree = false;
+        }
+        std::cout << names[k] << " (" << 8 * sizeof(value_t) << "-bit costs): " << 1e9 * elapsed.count() / ((double) repetitions * m) << " ns/edge, best edge " << best << " with reduced cost " << c << std::endl;
+    }
+    return agree;
+}
 
 int main(int argc, char** argv) {
   std::string outputfile = "";
     std::string filename = "";
     bool filenameSpecified = false;
     bool outputfileSpecified = false;
+    bool printStats = false;
+    bool benchmarkPricing = false;
+    bool crossCheck = false;
+    bool decompose = false;
+    std::string engine = "simplex";
+    unsigned int warmStartRounds = 0;
+    std::string batchInput = "";
+    unsigned int batchWorkers = 1;
+    std::string binaryfile = "";
+    std::string statsfile = "";
+    std::string verifyfile = "";
+    bool writePotentials = false;
+    simplex_options options;
     for (int i=1; i<argc; i++) {
         if (argv[i][0] == '-') {
+            char flag = argv[i][1];
             // Output file can be specified
-            if (argv[i][1] == 'o') {
+            if (flag == 'o') {
                 if (i+1 < argc) {
                     outputfile = std::string(argv[i+1]);
                     outputfileSpecified = true;
                     i++;
                 }
             }
+            // Pricing strategy can be specified (first, block, candidate, dantzig)
+            if (flag == 'p') {
+                if (i+1 < argc) {
+                    options.strategy = parse_pricing_strategy(std::string(argv[i+1]));
+                    i++;
+                }
+            }
+            // Number of threads used for pricing
+            if (flag == 't') {
+                if (i+1 < argc) {
+                    options.threads = std::max(1, std::atoi(argv[i+1]));
+                    i++;
+                }
+            }
+            // Converts the input to the binary format instead of solving it
+            if (flag == 'b') {
+                if (i+1 < argc) {
+                    binaryfile = std::string(argv[i+1]);
+                    i++;
+                }
+            }
+            // Pricing kernel can be specified (auto, scalar, avx2, avx512)
+            if (flag == 'k') {
+                if (i+1 < argc) {
+                    options.kernel = std::string(argv[i+1]);
+                    select_pricing_kernel<cost_t>(options.kernel); // throws if the kernel is unknown or not supported
+                    i++;
+                }
+            }
+            // Benchmarks the pricing kernels on the edges of the input instead of solving it
+            if (flag == 'm') {
+                benchmarkPricing = true;
+            }
+            // Engine that solves the instance (simplex, costscaling)
+            if (flag == 'e') {
+                if (i+1 < argc) {
+                    engine = std::string(argv[i+1]);
+                    if (engine != "simplex" && engine != "costscaling") {
+                        throw(std::runtime_error("Unknown engine: " + engine));
+                    }
+                    i++;
+                }
+            }
+            // Initial basis of the network simplex (artificial, crash)
+            if (flag == 'i') {
+                if (i+1 < argc) {
+                    std::string start(argv[i+1]);
+                    if (start != "artificial" && start != "crash") {
+                        throw(std::runtime_error("Unknown initial basis: " + start));
+                    }
+                    options.crash = start == "crash";
+                    i++;
+                }
+            }
+            // Keeps 64-bit capacities and costs even if 32 bits would suffice
+            if (flag == 'x') {
+                options.compact = false;
+            }
+            // Stops the simplex after the given number of seconds, the current flow is written if it is feasible
+            if (flag == 'T') {
+                if (i+1 < argc) {
+                    options.time_limit = std::atof(argv[i+1]);
+                    i++;
+                }
+            }
+            // Stops the simplex after the given number of pivots
+            if (flag == 'P') {
+                if (i+1 < argc) {
+                    options.pivot_limit = std::strtoull(argv[i+1], nullptr, 10);
+                    i++;
+                }
+            }
+            // Prints the progress of the simplex to stderr every given number of pivots
+            if (flag == 'g') {
+                if (i+1 < argc) {
+                    options.progress_interval = std::strtoull(argv[i+1], nullptr, 10);
+                    options.progress = [](simplex_progress& p) {
+                        std::cerr << "pivots: " << p.pivots << ", time: " << p.elapsed << "s, pivots/s: " << (unsigned long long) p.pivots_per_second
+                            << ", objective: " << p.objective << ", artificial edges with flow: " << p.artificial_edges << std::endl;
+                    };
+                    i++;
+                }
+            }
+            // Solves the input with both engines and compares the results
+            if (flag == 'c') {
+                crossCheck = true;
+            }
+            // Benchmarks warm-started re-solves after small changes for the given number of rounds
+            if (flag == 'w') {
+                if (i+1 < argc) {
+                    warmStartRounds = std::atoi(argv[i+1]);
+                    i++;
+                }
+            }
+            // Solves all instances of a directory or manifest file, the results go to the directory given by -o
+            if (flag == 'l') {
+                if (i+1 < argc) {
+                    batchInput = std::string(argv[i+1]);
+                    i++;
+                }
+            }
+            // Preprocesses the instance and solves its weakly connected components independently
+            if (flag == 'd') {
+                decompose = true;
+            }
+            // Number of instances (batch mode) or components (-d) that are solved concurrently
+            if (flag == 'j') {
+                if (i+1 < argc) {
+                    batchWorkers = std::max(1, std::atoi(argv[i+1]));
+                    i++;
+                }
+            }
+            // Per-phase statistics are appended to the given CSV or JSON file
+            if (flag == 'r') {
+                if (i+1 < argc) {
+                    statsfile = std::string(argv[i+1]);
+                    options.timings = true;
+                    i++;
+                }
+            }
+            // Checks the given solution of the input instead of solving it
+            if (flag == 'V') {
+                if (i+1 < argc) {
+                    verifyfile = std::string(argv[i+1]);
+                    i++;
+                }
+            }
+            // Potentials of the optimal tree are appended to the output (-V then checks complementary slackness as well)
+            if (flag == 'u') {
+                writePotentials = true;
+            }
+            // Statistics are printed to stderr
+            if (flag == 'v') {
+                printStats = true;
+            }
         } else {
             filename = argv[i];
             filenameSpecified = true;
         }
     }
 
+    if (batchInput != "") {
+        std::string outputDir = outputfileSpecified ? outputfile : "results";
+        std::vector<std::string> instances = read_batch_instances(batchInput);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<batch_result> results = solve_batch(instances, outputDir, options, batchWorkers);
+        std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+        std::ofstream summary(outputDir + "/summary.txt");
+        write_batch_summary(results, summary);
+        write_batch_summary(results, std::cout);
+        std::cout << "wall time: " << wall_time.count() << "s with " << batchWorkers << " workers" << std::endl;
+
+        // Like a single solve: 1 if an instance has failed, 2 if one has only a feasible flow
+        int status = 0;
+        for (batch_result& r : results) {
+            if (!r.error.empty()) {
+                status = 1;
+            } else if (r.status != OPTIMAL && status == 0) {
+                status = 2;
+            }
+        }
+        return status;
+    }
+
     if (!filenameSpecified) {
         std::cout << "Please specify your input filename." << '\n';
         return 0;
     }
     
+    auto start = std::chrono::steady_clock::now();
     Graph g(filename);
+    std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - start;
+
+    if (binaryfile != "") {
+        g.write_binary(binaryfile);
+        return 0;
+    }
+
+    if (benchmarkPricing) {
+        cost_t reference_cost = 0;
+        edge_t reference_edge = 0;
+        bool has_reference = false;
+        bool agree = run_pricing_benchmark(g, reference_cost, reference_edge, has_reference);
+        if (fits_compact(g)) {
+            CompactGraph compact = make_compact(g);
+            agree = run_pricing_benchmark(compact, reference_cost, reference_edge, has_reference) && agree;
+        }
+        std::cout << (agree ? "Kernels agree" : "Kernels disagree") << std::endl;
+        return agree ? 0 : 1;
+    }
 
-    std::vector<flow_t> flow = network_simplex(g);
+    if (warmStartRounds > 0) {
+        bool passed = run_warm_start_benchmark(g, options, warmStartRounds);
+        std::cout << (passed ? "Warm starts match cold starts" : "Warm start differs from cold start") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    if (verifyfile != "") {
+        cost_t objective;
+        std::vector<flow_t> flow;
+        std::vector<pot_t> pot;
+        bool hasPotentials = read_solution(verifyfile, g, objective, flow, pot);
+        start = std::chrono::steady_clock::now();
+        verify_result result = verify_solution(g, flow, hasPotentials ? &pot : nullptr, options.threads);
+        std::chrono::duration<double> verify_time = std::chrono::steady_clock::now() - start;
+        if (result.objective != objective) {
+            std::cout << "Stated objective " << objective << " differs from the cost of the flow " << result.objective << std::endl;
+        }
+        std::cout << "capacity violations: " << result.bound_violations << ", conservation violations: " << result.conservation_violations;
+        if (hasPotentials) {
+            std::cout << ", slackness violations: " << result.slackness_violations;
+        }
+        std::cout << std::endl;
+        if (!result.first_error.empty()) {
+            std::cout << "first violation: " << result.first_error << std::endl;
+        }
+        if (printStats) {
+            std::cerr << "verify time: " << verify_time.count() << "s with " << options.threads << " threads" << std::endl;
+        }
+        bool passed = result.passed() && result.objective == objective;
+        std::cout << (passed ? "Verification passed" : "Verification failed") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    if (crossCheck) {
+        bool agree = run_engine_cross_check(g, options);
+        std::cout << (agree ? "Engines agree" : "Engines disagree") << std::endl;
+        return agree ? 0 : 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    simplex_stats stats;
+    cost_scaling_stats scaling_stats;
+    preprocess_stats component_stats;
+    std::vector<flow_t> flow;
+    std::vector<pot_t> pot;
+    if ((decompose || engine == "costscaling") && writePotentials) {
+        throw(std::runtime_error("Potentials are only written by the network simplex without -d."));
+    }
+    if (decompose) {
+        std::mutex stats_mutex, progress_mutex;
+        component_solver solve = [&](Graph& h, node_t c) {
+            // The components report their progress one at a time, each report is tagged with its component
+            simplex_options component_options = options;
+            if (options.progress) {
+                component_options.progress = [&, c](simplex_progress& p) {
+                    std::lock_guard<std::mutex> lock(progress_mutex);
+                    std::cerr << "component " << c << ": ";
+                    options.progress(p);
+                };
+            }
+            simplex_stats component_run;
+            cost_scaling_stats scaling_run;
+            std::vector<flow_t> component_flow = engine == "costscaling" ? cost_scaling(h, scaling_run) : network_simplex(h, component_options, component_run);
+            require_feasible(component_run);
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            // A component stopped by a limit makes the whole flow feasible but not optimal
+            if (component_run.status != OPTIMAL) {
+                stats.status = component_run.status;
+            }
+            stats.feasible = stats.feasible && component_run.feasible;
+            stats.pivots += component_run.pivots;
+            // The widest component is reported
+            if (component_run.value_bits >= stats.value_bits) {
+                stats.value_bits = component_run.value_bits;
+                stats.kernel = component_run.kernel;
+            }
+            stats.degenerate_pivots += component_run.degenerate_pivots;
+            stats.init_time += component_run.init_time;
+            stats.pricing_time += component_run.pricing_time;
+            stats.ratio_test_time += component_run.ratio_test_time;
+            stats.tree_update_time += component_run.tree_update_time;
+            scaling_stats.pushes += scaling_run.pushes;
+            scaling_stats.relabels += scaling_run.relabels;
+            scaling_stats.phases += scaling_run.phases;
+            return component_flow;
+        };
+        flow = solve_components(g, solve, batchWorkers, component_stats);
+    } else if (engine == "costscaling") {
+        flow = cost_scaling(g, scaling_stats);
+    } else {
+        flow = network_simplex(g, options, stats, writePotentials ? &pot : nullptr);
+    }
+    std::chrono::duration<double> solve_time = std::chrono::steady_clock::now() - start;
+
+    require_feasible(stats);
+    if (stats.status != OPTIMAL) {
+        std::cerr << "Solve stopped early (" << solve_status_name(stats.status) << "), the flow is feasible but not optimal." << std::endl;
+    }
+
+    if (printStats) {
+        std::cerr << "load time: " << load_time.count() << "s" << std::endl;
+        std::cerr << "solve time: " << solve_time.count() << "s" << std::endl;
+        if (decompose) {
+            std::cerr << "components: " << component_stats.components << ", dropped zero capacity edges: " << component_stats.zero_cap_edges
+                << ", self-loops: " << component_stats.self_loops << ", merged parallel edges: " << component_stats.merged_edges << std::endl;
+        }
+        if (engine == "costscaling") {
+            std::cerr << "phases: " << scaling_stats.phases << ", pushes: " << scaling_stats.pushes << ", relabels: " << scaling_stats.relabels << std::endl;
+        } else {
+            std::cerr << "pivots: " << stats.pivots << " (" << stats.degenerate_pivots << " degenerate)" << std::endl;
+            std::cerr << "pricing kernel: " << stats.kernel << std::endl;
+            std::cerr << "capacities and costs: " << stats.value_bits << "-bit" << std::endl;
+        }
+    }
 
     std::fstream outfile;
     std::ostream *out;
@@ -44,5 +575,13 @@ int main(int argc, char** argv) {
     } else {
       out = &std::cout;
     }
-    g.export_min_cost_flow(flow, *out);
+    start = std::chrono::steady_clock::now();
+    g.export_min_cost_flow(flow, *out, writePotentials ? &pot : nullptr);
+    out->flush();
+    std::chrono::duration<double> export_time = std::chrono::steady_clock::now() - start;
+
+    if (statsfile != "") {
+        write_run_stats(statsfile, filename, engine, options, stats, load_time.count(), export_time.count(), flow_cost(g, flow));
+    }
+    return stats.status == OPTIMAL ? 0 : 2;
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+/* Stress test of the spanning tree on long paths */
+#include "SpanningTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// Builds a path-shaped spanning tree with n nodes, reverses it with a single re-hang and checks the tree structure
+bool run_tree_stress_test(node_t n) {
+    Graph g(n);
+    for (node_t i=0; i<n; i++) {
+        g.add_edge(i, i+1, 1, 1); // edge n-1 goes to the root
+    }
+    g.add_edge(0, n, 1, 1);
+    g.edge_count = n+1;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // root - n-1 - n-2 - ... - 0
+    SpanningTree tree(n);
+    std::vector<pot_t> pot(n+1, 0);
+    for (node_t i=0; i<n; i++) {
+        tree.prev[i] = i;
+    }
+    tree.build(g);
+    tree.compute_potentials(g, pot);
+    for (node_t i=0; i<n; i++) {
+        if (tree.depth[i] != n-i || tree.succ_num[i] != i+1 || pot[i] != -(pot_t)(n-i)) {
+            return false;
+        }
+    }
+
+    // Replace the edge n-1 -> root by 0 -> root: root - 0 - 1 - ... - n-1
+    tree.prev[0] = n;
+    for (node_t i=1; i<n; i++) {
+        tree.prev[i] = i-1;
+    }
+    tree.rehang(0, n, n-1, g, pot);
+    node_t x = tree.thread[n];
+    for (node_t i=0; i<n; i++, x = tree.thread[x]) {
+        if (x != i || tree.parent[i] != (i == 0 ? n : i-1) || tree.depth[i] != i+1 || tree.succ_num[i] != n-i || pot[i] != (pot_t) i-1) {
+            return false;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "tree stress test with " << n << " nodes: " << elapsed.count() << "s" << std::endl;
+    return x == n;
+}
+
+// Runs the test on a path with the given number of nodes (1000000 by default)
+int main(int argc, char** argv) {
+    long long n = 1000000;
+    if (argc > 1) {
+        char* end;
+        n = std::strtoll(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || n < 1 || n >= std::numeric_limits<node_t>::max()) {
+            std::cout << "Usage: tree_stress_test [number of nodes, at least 1]" << std::endl;
+            return 1;
+        }
+    }
+    bool passed = run_tree_stress_test(n);
+    std::cout << (passed ? "Stress test passed" : "Stress test failed") << std::endl;
+    return passed ? 0 : 1;
+}